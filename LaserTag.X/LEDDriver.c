@@ -4,12 +4,7 @@
 #include "i2cMaster.h"
 
 #include <stdbool.h>
-#include <string.h>  // for memcpy
 
-// 37 bytes: register address + max 36 data packets
-// TODO investigate whether we need this to be a global variable, or if we can
-// efficiently create function-local arrays
-static uint8_t g_data[37];
 static uint8_t g_address = 0b0111100;  // 7-bit I2C address of LED driver
 
 const uint8_t REG_SHUTDOWN = 0x00;
@@ -21,19 +16,30 @@ const uint8_t REG_RESET = 0x4F;
 
 static bool isValidRange(uint8_t start_index, uint8_t length)
 {
-    return start_index + length <= 36;
+    return start_index + length <= LED_DRIVER_CHANNEL_COUNT;
 }
 
-static void setRegisters(uint8_t register_address, uint8_t start_index, uint8_t* data, uint8_t data_len)
+// Reserve one transmission in the I2C queue for the start register's address followed by the values, and return where
+// to write the values
+static void reserveRegisters(uint8_t register_address, uint8_t start_index, uint8_t length,
+                             circular_buffer_span_t* span_out)
 {
-    if (!isValidRange(start_index, data_len))
+    if (!isValidRange(start_index, length))
         fatal(ERROR_LED_DRIVER_INVALID_REG_RANGE);
 
-    g_data[0] = register_address + start_index;
-    // Copy given data into our global data array
-    memcpy(g_data + 1, data, data_len);
+    i2cMaster_reserveWrite(g_address, length + 1, span_out);
+    circularBuffer_spanSet(span_out, 0, register_address + start_index);
+    circularBuffer_spanSkip(span_out, 1);
+}
 
-    i2cMaster_write(g_address, g_data, data_len + 1);
+static void setRegisters(uint8_t register_address, uint8_t start_index, const uint8_t* data, uint8_t data_len)
+{
+    // The data is copied once, straight into the I2C queue
+    circular_buffer_span_t span;
+    reserveRegisters(register_address, start_index, data_len, &span);
+    for (uint8_t i = 0; i < data_len; i++)
+        circularBuffer_spanSet(&span, i, data[i]);
+    LEDDriver_commit(data_len);
 }
 
 static void setRegister(uint8_t register_address, uint8_t data)
@@ -48,7 +54,7 @@ void LEDDriver_setShutdown(bool shutdown)
     setRegister(REG_SHUTDOWN, shutdown ? 0 : 1);
 }
 
-void LEDDriver_setPWM(uint8_t start_index, uint8_t* pwm, uint8_t pwm_len)
+void LEDDriver_setPWM(uint8_t start_index, const uint8_t* pwm, uint8_t pwm_len)
 {
     setRegisters(REG_PWM, start_index, pwm, pwm_len);
 }
@@ -57,11 +63,27 @@ void LEDDriver_flushChanges()
 {
     setRegister(REG_UPDATE, 0);
 }
-void LEDDriver_setControl(uint8_t start_index, uint8_t* control, uint8_t control_len)
+void LEDDriver_setControl(uint8_t start_index, const uint8_t* control, uint8_t control_len)
 {
     setRegisters(REG_CONTROL, start_index, control, control_len);
 }
 
+void LEDDriver_reservePWM(uint8_t start_index, uint8_t pwm_len, circular_buffer_span_t* span_out)
+{
+    reserveRegisters(REG_PWM, start_index, pwm_len, span_out);
+}
+
+void LEDDriver_reserveControl(uint8_t start_index, uint8_t control_len, circular_buffer_span_t* span_out)
+{
+    reserveRegisters(REG_CONTROL, start_index, control_len, span_out);
+}
+
+void LEDDriver_commit(uint8_t length)
+{
+    // The start register's address goes before the values
+    i2cMaster_commitWrite(length + 1);
+}
+
 void LEDDriver_setGlobalEnable(bool enable)
 {
     setRegister(REG_GLOBAL_CONTROL, enable ? 0 : 1);
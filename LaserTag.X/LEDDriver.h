@@ -1,16 +1,27 @@
 #ifndef LEDDRIVER_H
 #define LEDDRIVER_H
 
+#include "../LaserTagUtils.X/circularBuffer.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
+// The number of LEDs, each with a PWM register and a control register
+#define LED_DRIVER_CHANNEL_COUNT 36
+
 // All of these functions return false if there is a transmission currently in
 // progress. These functions are NOT thread safe - do not call them in ISRs.
 void LEDDriver_setShutdown(bool shutdown);
-void LEDDriver_setPWM(uint8_t start_index, uint8_t* pwm, uint8_t pwm_len);
+void LEDDriver_setPWM(uint8_t start_index, const uint8_t* pwm, uint8_t pwm_len);
 void LEDDriver_flushChanges(void);
-void LEDDriver_setControl(uint8_t start_index, uint8_t* control, uint8_t control_len);
+void LEDDriver_setControl(uint8_t start_index, const uint8_t* control, uint8_t control_len);
 void LEDDriver_setGlobalEnable(bool enable);
 void LEDDriver_reset(void);
 
+// Zero-copy versions of LEDDriver_setPWM and LEDDriver_setControl. Reserve room in the I2C queue for the given range of
+// registers and return where to write their values, then queue them with LEDDriver_commit, passing the same length
+void LEDDriver_reservePWM(uint8_t start_index, uint8_t pwm_len, circular_buffer_span_t* span_out);
+void LEDDriver_reserveControl(uint8_t start_index, uint8_t control_len, circular_buffer_span_t* span_out);
+void LEDDriver_commit(uint8_t length);
+
 #endif /* LEDDRIVER_H */
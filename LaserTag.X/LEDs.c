@@ -29,28 +29,31 @@ void flashHitLight()
 
 void setBarDisplay1(uint16_t bits)
 {
-    uint8_t data[10];
+    // Write the values straight into the I2C queue
+    circular_buffer_span_t data;
+    LEDDriver_reserveControl(0, 10, &data);
 
     for (int i = 0; i < 10; i++)
     {
-        data[i] = (bits >> i) & 1;
+        circularBuffer_spanSet(&data, i, (bits >> i) & 1);
     }
 
-    LEDDriver_setControl(0, data, 10);
+    LEDDriver_commit(10);
     LEDDriver_flushChanges();
 }
 
 void setBarDisplay2(uint16_t bits)
 {
-    uint8_t data[10];
+    circular_buffer_span_t data;
+    LEDDriver_reserveControl(10, 10, &data);
 
     for (int i = 0; i < 10; i++)
     {
         // Reverse, as this bar display is installed upside down
-        data[10 - i - 1] = (bits >> i) & 1;
+        circularBuffer_spanSet(&data, 10 - i - 1, (bits >> i) & 1);
     }
 
-    LEDDriver_setControl(10, data, 10);
+    LEDDriver_commit(10);
     LEDDriver_flushChanges();
 }
 
@@ -1,6 +1,7 @@
 #include "crc.h"
 
 #include "crcConstants.h"
+#include "error.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -33,20 +34,37 @@ static uint8_t calculateCRC(uint8_t data)
     return remainder >> (8 - CRC_LENGTH);
 }
 
-static uint8_t CRC_LOOKUP[256];
+// The CRC of every byte, precomputed with calculateCRC. Being const, the table lives in program memory instead of
+// taking 256 bytes of RAM. If the polynomial or CRC length changes, regenerate it; initializeCRC checks it against
+// calculateCRC at boot
+static const uint8_t CRC_LOOKUP[256] = {
+    0x00, 0x0B, 0x16, 0x1D, 0x07, 0x0C, 0x11, 0x1A, 0x0E, 0x05, 0x18, 0x13, 0x09, 0x02, 0x1F, 0x14,
+    0x1C, 0x17, 0x0A, 0x01, 0x1B, 0x10, 0x0D, 0x06, 0x12, 0x19, 0x04, 0x0F, 0x15, 0x1E, 0x03, 0x08,
+    0x13, 0x18, 0x05, 0x0E, 0x14, 0x1F, 0x02, 0x09, 0x1D, 0x16, 0x0B, 0x00, 0x1A, 0x11, 0x0C, 0x07,
+    0x0F, 0x04, 0x19, 0x12, 0x08, 0x03, 0x1E, 0x15, 0x01, 0x0A, 0x17, 0x1C, 0x06, 0x0D, 0x10, 0x1B,
+    0x0D, 0x06, 0x1B, 0x10, 0x0A, 0x01, 0x1C, 0x17, 0x03, 0x08, 0x15, 0x1E, 0x04, 0x0F, 0x12, 0x19,
+    0x11, 0x1A, 0x07, 0x0C, 0x16, 0x1D, 0x00, 0x0B, 0x1F, 0x14, 0x09, 0x02, 0x18, 0x13, 0x0E, 0x05,
+    0x1E, 0x15, 0x08, 0x03, 0x19, 0x12, 0x0F, 0x04, 0x10, 0x1B, 0x06, 0x0D, 0x17, 0x1C, 0x01, 0x0A,
+    0x02, 0x09, 0x14, 0x1F, 0x05, 0x0E, 0x13, 0x18, 0x0C, 0x07, 0x1A, 0x11, 0x0B, 0x00, 0x1D, 0x16,
+    0x1A, 0x11, 0x0C, 0x07, 0x1D, 0x16, 0x0B, 0x00, 0x14, 0x1F, 0x02, 0x09, 0x13, 0x18, 0x05, 0x0E,
+    0x06, 0x0D, 0x10, 0x1B, 0x01, 0x0A, 0x17, 0x1C, 0x08, 0x03, 0x1E, 0x15, 0x0F, 0x04, 0x19, 0x12,
+    0x09, 0x02, 0x1F, 0x14, 0x0E, 0x05, 0x18, 0x13, 0x07, 0x0C, 0x11, 0x1A, 0x00, 0x0B, 0x16, 0x1D,
+    0x15, 0x1E, 0x03, 0x08, 0x12, 0x19, 0x04, 0x0F, 0x1B, 0x10, 0x0D, 0x06, 0x1C, 0x17, 0x0A, 0x01,
+    0x17, 0x1C, 0x01, 0x0A, 0x10, 0x1B, 0x06, 0x0D, 0x19, 0x12, 0x0F, 0x04, 0x1E, 0x15, 0x08, 0x03,
+    0x0B, 0x00, 0x1D, 0x16, 0x0C, 0x07, 0x1A, 0x11, 0x05, 0x0E, 0x13, 0x18, 0x02, 0x09, 0x14, 0x1F,
+    0x04, 0x0F, 0x12, 0x19, 0x03, 0x08, 0x15, 0x1E, 0x0A, 0x01, 0x1C, 0x17, 0x0D, 0x06, 0x1B, 0x10,
+    0x18, 0x13, 0x0E, 0x05, 0x1F, 0x14, 0x09, 0x02, 0x16, 0x1D, 0x00, 0x0B, 0x11, 0x1A, 0x07, 0x0C
+};
 
-static void populateCRCLookup()
+void initializeCRC(void)
 {
     for (int i = 0; i < 256; i++)
     {
-        CRC_LOOKUP[i] = calculateCRC(i);
+        if (CRC_LOOKUP[i] != calculateCRC(i))
+            fatal(ERROR_CRC_LOOKUP_OUT_OF_DATE);
     }
 }
 
-void initializeCRC(void)
-{
-    populateCRCLookup();
-}
 uint8_t crc(uint8_t data)
 {
     return CRC_LOOKUP[data];
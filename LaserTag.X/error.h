@@ -21,7 +21,9 @@ enum
     ERROR_RECEIVED_TRANSMISSION_TOO_LONG,
     ERROR_I2C_MALFORMED_READ_REQUEST,
     ERROR_IR_XCVR_UNEXPECTED_READ_LENGTH_RESPONSE,
-    ERROR_IR_XCVR_UNEXPECTED_READ_DATA_RESPONSE
+    ERROR_IR_XCVR_UNEXPECTED_READ_DATA_RESPONSE,
+    ERROR_CRC_LOOKUP_OUT_OF_DATE,
+    ERROR_FEC_TABLES_OUT_OF_DATE
 };
 
 void fatal(uint8_t error_code);
@@ -1,7 +1,7 @@
 #include "i2cMaster.h"
 
-#include "../LaserTagUtils.X/keyedStringQueue.h"
-#include "../LaserTagUtils.X/stringQueue.h"
+#include "../LaserTagUtils.X/framedStringQueue.h"
+#include "../LaserTagUtils.X/keyedLaneQueue.h"
 #include "error.h"
 #include "pins.h"
 
@@ -13,13 +13,24 @@
 #define OUTGOING_MESSAGE_QUEUE_LENGTH 128
 
 uint8_t g_outgoing_message_queue_storage[OUTGOING_MESSAGE_QUEUE_LENGTH];
-string_queue_t g_outgoing_message_queue;
+// Framed with length headers so that checking for a queued message, which happens on every event handler call, is O(1)
+framed_string_queue_t g_outgoing_message_queue;
 bool g_outgoing_message_in_progress = false;
+// The message at the front of the outgoing queue, which is being sent. It's read in place, a byte at a time, and only
+// released from the queue once its last byte has been sent
+circular_buffer_span_t g_outgoing_message;
+uint8_t g_outgoing_message_length;
+// The index in the message of the next byte to send
+uint8_t g_outgoing_message_index;
 
-#define INCOMING_MESSAGE_QUEUE_LENGTH 128
+// Received shots arrive through this queue, so it gets the RAM freed by moving the CRC lookup table to program memory.
+// Each block of the lane queue takes 10 bytes of storage, so this is the most blocks that fit in its 8-bit length
+#define INCOMING_MESSAGE_QUEUE_LENGTH 250
 
 uint8_t g_incoming_message_queue_storage[INCOMING_MESSAGE_QUEUE_LENGTH];
-string_queue_t g_incoming_message_queue;
+// Keyed by slave address, with one lane per address, so that fetching the reads for one address doesn't scan or compact
+// the reads queued for the others
+keyed_lane_queue_t g_incoming_message_queue;
 
 void i2cMaster_initialize()
 {
@@ -50,8 +61,10 @@ void i2cMaster_initialize()
     // Enable slew rate control for 400kHz mode
     SSP1STATbits.SMP = 0;
 
-    g_outgoing_message_queue = stringQueue_create(g_outgoing_message_queue_storage, OUTGOING_MESSAGE_QUEUE_LENGTH);
-    g_incoming_message_queue = stringQueue_create(g_incoming_message_queue_storage, INCOMING_MESSAGE_QUEUE_LENGTH);
+    g_outgoing_message_queue
+        = framedStringQueue_create(g_outgoing_message_queue_storage, OUTGOING_MESSAGE_QUEUE_LENGTH);
+    g_incoming_message_queue
+        = keyedLaneQueue_create(g_incoming_message_queue_storage, INCOMING_MESSAGE_QUEUE_LENGTH);
 }
 
 void i2cMaster_shutdown()
@@ -75,7 +88,7 @@ void i2cMaster_writePartial(uint8_t address, uint8_t* data, uint8_t data_length,
         current_address = address;
         // The 7-bit address must sit in the most significant bits, with the LSB for the R/W bit
         address <<= 1;
-        if (!stringQueue_pushPartial(&g_outgoing_message_queue, &address, 1, false))
+        if (!framedStringQueue_pushPartial(&g_outgoing_message_queue, &address, 1, false))
             fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
 
         transmission_partially_written = true;
@@ -87,13 +100,29 @@ void i2cMaster_writePartial(uint8_t address, uint8_t* data, uint8_t data_length,
             fatal(ERROR_I2C_PARTIAL_WRITE_ADDRESS_MISMATCH);
     }
 
-    if (!stringQueue_pushPartial(&g_outgoing_message_queue, data, data_length, is_last_part))
+    if (!framedStringQueue_pushPartial(&g_outgoing_message_queue, data, data_length, is_last_part))
         fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
 
     if (is_last_part)
         transmission_partially_written = false;
 }
 
+void i2cMaster_reserveWrite(uint8_t address, uint8_t data_length, circular_buffer_span_t* span_out)
+{
+    // Reserve room for the address too, and write it now
+    if (!framedStringQueue_reserve(&g_outgoing_message_queue, data_length + 1, span_out))
+        fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
+
+    // The 7-bit address must sit in the most significant bits, with the LSB for the R/W bit
+    circularBuffer_spanSet(span_out, 0, address << 1);
+    circularBuffer_spanSkip(span_out, 1);
+}
+
+void i2cMaster_commitWrite(uint8_t data_length)
+{
+    framedStringQueue_commit(&g_outgoing_message_queue, data_length + 1);
+}
+
 void i2cMaster_read(uint8_t address, uint8_t read_length)
 {
     if (read_length == 0)
@@ -103,28 +132,28 @@ void i2cMaster_read(uint8_t address, uint8_t read_length)
     address <<= 1;
     // Set the Read bit
     address |= 1;
-    if (!stringQueue_pushPartial(&g_outgoing_message_queue, &address, 1, false))
+    if (!framedStringQueue_pushPartial(&g_outgoing_message_queue, &address, 1, false))
         fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
     // Push the length into the queue as the second byte of the message. We will use this byte to determine when to stop
     // asking for more bytes from the slave
-    if (!stringQueue_pushPartial(&g_outgoing_message_queue, &read_length, 1, true))
+    if (!framedStringQueue_pushPartial(&g_outgoing_message_queue, &read_length, 1, true))
         fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
 }
 
 bool i2cMaster_getReadResults(uint8_t address, uint8_t max_length, uint8_t* data_out, uint8_t* length_out)
 {
-    if (!keyedStringQueue_hasFullString(&g_incoming_message_queue, address))
+    if (!keyedLaneQueue_hasFullString(&g_incoming_message_queue, address))
     {
         *length_out = 0;
         return false;
     }
 
-    return keyedStringQueue_pop(&g_incoming_message_queue, address, max_length, data_out, length_out);
+    return keyedLaneQueue_pop(&g_incoming_message_queue, address, max_length, data_out, length_out);
 }
 
 static bool isOutgoingQueueEmpty()
 {
-    return !stringQueue_hasFullString(&g_outgoing_message_queue);
+    return !framedStringQueue_hasFullString(&g_outgoing_message_queue);
 }
 
 typedef enum {
@@ -139,6 +168,8 @@ typedef enum {
 i2cModuleState_t g_i2c_module_state = I2C_STATE_IDLE;
 // Non-zero when reading from slave, zero when writing to slave
 uint8_t g_read_length = 0;
+// The address of the slave being read from, used as the key for the bytes read
+uint8_t g_read_address = 0;
 
 bool i2cMaster_isIdle()
 {
@@ -177,11 +208,16 @@ static void stateChange_stop()
 
 static void stateChange_writeNextByteToBuffer(bool isAddress)
 {
-    uint8_t next_byte;
-    uint8_t out_length;
-    bool next_byte_is_last = stringQueue_pop(&g_outgoing_message_queue, 1, &next_byte, &out_length);
+    // A message starts with its address
+    if (isAddress)
+    {
+        g_outgoing_message_length = framedStringQueue_peek(&g_outgoing_message_queue, &g_outgoing_message);
+        g_outgoing_message_index = 0;
+    }
+
+    uint8_t next_byte = circularBuffer_spanGet(&g_outgoing_message, g_outgoing_message_index);
+    g_outgoing_message_index++;
     SSP1BUF = next_byte;
-    g_outgoing_message_in_progress = !next_byte_is_last;
 
     if (WCOL == 1)
     {
@@ -195,17 +231,19 @@ static void stateChange_writeNextByteToBuffer(bool isAddress)
 
         if (read)
         {
-            // Pop the read length from the outgoing message queue
-            bool is_last = stringQueue_pop(&g_outgoing_message_queue, 1, &g_read_length, &out_length);
-            assert(is_last, ERROR_I2C_MALFORMED_READ_REQUEST);
+            // The read length is the rest of the message
+            assert(g_outgoing_message_length == 2, ERROR_I2C_MALFORMED_READ_REQUEST);
+            g_read_length = circularBuffer_spanGet(&g_outgoing_message, g_outgoing_message_index);
+            g_outgoing_message_index++;
             // Shift off the R/W bit appended to the address
-            uint8_t addr = next_byte >> 1;
-            // Write the address for the read to the incoming message queue
-            if (!stringQueue_pushPartial(&g_incoming_message_queue, &addr, 1, false))
-                fatal(ERROR_I2C_INCOMING_QUEUE_FULL);
+            g_read_address = next_byte >> 1;
         }
     }
 
+    g_outgoing_message_in_progress = g_outgoing_message_index != g_outgoing_message_length;
+    if (!g_outgoing_message_in_progress)
+        framedStringQueue_release(&g_outgoing_message_queue);
+
     g_i2c_module_state = I2C_STATE_ACK_RECEIVED;
 }
 
@@ -222,7 +260,7 @@ static void stateChange_readByteFromBuffer()
     bool is_last_byte = (g_read_length == 0);
 
     uint8_t byte = SSP1BUF;
-    if (!stringQueue_pushPartial(&g_incoming_message_queue, &byte, 1, is_last_byte))
+    if (!keyedLaneQueue_pushPartial(&g_incoming_message_queue, g_read_address, &byte, 1, is_last_byte))
         fatal(ERROR_I2C_INCOMING_QUEUE_FULL);
 
     if (is_last_byte)
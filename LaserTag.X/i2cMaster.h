@@ -1,6 +1,8 @@
 #ifndef I2CMASTER_H
 #define I2CMASTER_H
 
+#include "../LaserTagUtils.X/circularBuffer.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -14,6 +16,12 @@ void i2cMaster_write(uint8_t address, uint8_t* data, uint8_t data_length);
 // Write a partial transmission. If is_last_part is false, the data in the next partial write will be appended to the
 // same transmission. Until is_last_part==true, all partial writes must be to the same address
 void i2cMaster_writePartial(uint8_t address, uint8_t* data, uint8_t data_length, bool is_last_part);
+// Zero-copy write. Reserves room in the queue for a transmission of the given length to the device with the given
+// address, and returns where to write its data. Must not be called between partial writes of a transmission
+void i2cMaster_reserveWrite(uint8_t address, uint8_t data_length, circular_buffer_span_t* span_out);
+// Queues the transmission reserved by the last call to i2cMaster_reserveWrite, once its data has been written. Takes
+// the same length
+void i2cMaster_commitWrite(uint8_t data_length);
 // Queues a read of the given number of bytes from the device with the given address. The read length must be greater
 // than zero
 void i2cMaster_read(uint8_t address, uint8_t read_length);
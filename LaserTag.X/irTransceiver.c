@@ -1,6 +1,7 @@
 #include "irTransceiver.h"
 
 #include "../LaserTagUtils.X/bitArray.h"
+#include "../LaserTagUtils.X/fec.h"
 #include "crc.h"
 #include "crcConstants.h"
 #include "error.h"
@@ -14,16 +15,48 @@ typedef enum {
     IR_RECEIVER_STATE_IDLE,
     IR_RECEIVER_STATE_AWAITING_LENGTH,
     IR_RECEIVER_STATE_AWAITING_DATA,
+    IR_RECEIVER_STATE_AWAITING_FAILURE_COUNTS,
+    IR_RECEIVER_STATE_AWAITING_TELEMETRY,
 } irReceiverState_t;
 
-// TODO share this between LaserTag and LaserTagTransceiver
-#define MAX_TRANSMISSION_LENGTH 120
-
-uint8_t g_transmission_buffer[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+// The data of the received transmission, followed by its reliability flags with SOFT_DECISION, then its sensor flags
+// with DUAL_SENSOR
+static uint8_t g_transmission_buffer[RECEIVED_TRANSMISSION_BYTES(MAX_TRANSMISSION_LENGTH)];
 // The length of the transmission currently in the buffer, in bits. length == 0 means there is no transmission available
 // at this time
 uint8_t g_transmission_length;
 
+// The sensor flags of the transmission most recently returned by a receive function
+uint8_t g_received_sensors = IR_TRANSCEIVER_SENSOR_1;
+#ifdef DUAL_SENSOR
+// False if the transmission most recently taken from the buffer was discarded, e.g. for failing its CRC, so that an
+// alternate to it should be used instead
+bool g_previous_transmission_used = true;
+#endif
+
+uint16_t g_receive_failure_counts[IR_RECEIVE_FAILURE_COUNT];
+
+// The most recent telemetry report, and whether it has arrived since the last call to irTransceiver_getTelemetry
+ir_receiver_telemetry_t g_telemetry;
+bool g_telemetry_available = false;
+
+static void addReceiveFailures(ir_receive_failure_t cause, uint8_t count)
+{
+    uint16_t total = g_receive_failure_counts[cause] + count;
+    g_receive_failure_counts[cause] = total < count ? UINT16_MAX : total;
+}
+
+// Count a failure for a transmission that was taken from the buffer but can't be used. Returns false, for returning
+// from a receive function
+static bool rejectTransmission(ir_receive_failure_t cause)
+{
+    addReceiveFailures(cause, 1);
+#ifdef DUAL_SENSOR
+    g_previous_transmission_used = false;
+#endif
+    return false;
+}
+
 void irTransceiver_eventHandler()
 {
     static irReceiverState_t state = IR_RECEIVER_STATE_IDLE;
@@ -57,12 +90,24 @@ void irTransceiver_eventHandler()
 
                     state = IR_RECEIVER_STATE_AWAITING_LENGTH;
                 }
+                else if (num_bits_to_read == RECEIVE_FAILURE_REPORT_MARKER)
+                {
+                    i2cMaster_read(TRANSCEIVER_ADDRESS, TRANSCEIVER_RECEIVE_FAILURE_COUNT);
+
+                    state = IR_RECEIVER_STATE_AWAITING_FAILURE_COUNTS;
+                }
+                else if (num_bits_to_read == TELEMETRY_REPORT_MARKER)
+                {
+                    i2cMaster_read(TRANSCEIVER_ADDRESS, sizeof(ir_receiver_telemetry_t));
+
+                    state = IR_RECEIVER_STATE_AWAITING_TELEMETRY;
+                }
                 else
                 {
                     if (num_bits_to_read > MAX_TRANSMISSION_LENGTH)
                         fatal(ERROR_RECEIVED_TRANSMISSION_TOO_LONG);
 
-                    i2cMaster_read(TRANSCEIVER_ADDRESS, NUM_BYTES(num_bits_to_read));
+                    i2cMaster_read(TRANSCEIVER_ADDRESS, RECEIVED_TRANSMISSION_BYTES(num_bits_to_read));
 
                     state = IR_RECEIVER_STATE_AWAITING_DATA;
                 }
@@ -78,12 +123,13 @@ void irTransceiver_eventHandler()
                 break;
 
             uint8_t received_data_length;
-            bool is_whole_message = i2cMaster_getReadResults(TRANSCEIVER_ADDRESS, NUM_BYTES(num_bits_to_read),
-                                                             g_transmission_buffer, &received_data_length);
+            bool is_whole_message
+                = i2cMaster_getReadResults(TRANSCEIVER_ADDRESS, RECEIVED_TRANSMISSION_BYTES(num_bits_to_read),
+                                           g_transmission_buffer, &received_data_length);
 
             if (received_data_length != 0)
             {
-                assert(received_data_length == NUM_BYTES(num_bits_to_read) && is_whole_message,
+                assert(received_data_length == RECEIVED_TRANSMISSION_BYTES(num_bits_to_read) && is_whole_message,
                        ERROR_IR_XCVR_UNEXPECTED_READ_DATA_RESPONSE);
 
                 g_transmission_length = num_bits_to_read;
@@ -96,6 +142,53 @@ void irTransceiver_eventHandler()
 
             break;
         }
+
+        case IR_RECEIVER_STATE_AWAITING_FAILURE_COUNTS:
+        {
+            uint8_t new_failure_counts[TRANSCEIVER_RECEIVE_FAILURE_COUNT];
+            uint8_t received_data_length;
+            bool is_whole_message = i2cMaster_getReadResults(TRANSCEIVER_ADDRESS, TRANSCEIVER_RECEIVE_FAILURE_COUNT,
+                                                             new_failure_counts, &received_data_length);
+
+            if (received_data_length != 0)
+            {
+                assert(received_data_length == TRANSCEIVER_RECEIVE_FAILURE_COUNT && is_whole_message,
+                       ERROR_IR_XCVR_UNEXPECTED_READ_DATA_RESPONSE);
+
+                for (uint8_t cause = 0; cause < TRANSCEIVER_RECEIVE_FAILURE_COUNT; cause++)
+                    addReceiveFailures(cause, new_failure_counts[cause]);
+
+                // Immediately start the next length read
+                i2cMaster_read(TRANSCEIVER_ADDRESS, 1);
+
+                state = IR_RECEIVER_STATE_AWAITING_LENGTH;
+            }
+
+            break;
+        }
+
+        case IR_RECEIVER_STATE_AWAITING_TELEMETRY:
+        {
+            // The report is the transceiver's ir_receiver_telemetry_t as laid out in its memory. See irLinkProtocol.h
+            uint8_t received_data_length;
+            bool is_whole_message = i2cMaster_getReadResults(TRANSCEIVER_ADDRESS, sizeof(ir_receiver_telemetry_t),
+                                                             (uint8_t*)&g_telemetry, &received_data_length);
+
+            if (received_data_length != 0)
+            {
+                assert(received_data_length == sizeof(ir_receiver_telemetry_t) && is_whole_message,
+                       ERROR_IR_XCVR_UNEXPECTED_READ_DATA_RESPONSE);
+
+                g_telemetry_available = true;
+
+                // Immediately start the next length read
+                i2cMaster_read(TRANSCEIVER_ADDRESS, 1);
+
+                state = IR_RECEIVER_STATE_AWAITING_LENGTH;
+            }
+
+            break;
+        }
     }
 }
 
@@ -106,32 +199,67 @@ void irTransceiver_transmit(uint8_t* bitarray, uint8_t bitarray_length)
     i2cMaster_writePartial(TRANSCEIVER_ADDRESS, bitarray, NUM_BYTES(bitarray_length), true);
 }
 
-bool irTransceiver_receive(uint8_t* bitarray_out, uint8_t bitarray_max_length, uint8_t* bitarray_length_out)
+// As irTransceiver_receive, except also copies the transmission's reliability flags into unreliable_out, if it isn't
+// null. Only has flags to copy with SOFT_DECISION
+static bool takeTransmission(uint8_t* bitarray_out, uint8_t* unreliable_out, uint8_t bitarray_max_length,
+                             uint8_t* bitarray_length_out)
 {
     if (g_transmission_length == 0)
         return false;
 
+    uint8_t num_bytes = NUM_BYTES(g_transmission_length);
+
+#ifdef DUAL_SENSOR
+    uint8_t sensors = g_transmission_buffer[RECEIVED_TRANSMISSION_DATA_BYTES(g_transmission_length)];
+    if ((sensors & ALTERNATE_TRANSMISSION_FLAG) && g_previous_transmission_used)
+    {
+        // Another sensor's version of a transmission that has already been used, so discard it without counting it as
+        // a failure
+        g_transmission_length = 0;
+        return false;
+    }
+#endif
+
     if (g_transmission_length > bitarray_max_length)
     {
         // Discard the current transmission by setting its length to zero
         g_transmission_length = 0;
-        return false;
+        return rejectTransmission(IR_RECEIVE_FAILURE_UNEXPECTED_LENGTH);
     }
 
-    // Copy the buffer into the out parameter and zero out the buffer
-    for (uint8_t i = 0; i < NUM_BYTES(g_transmission_length); i++)
+    // Copy the buffer into the out parameters and zero out the buffer
+    for (uint8_t i = 0; i < num_bytes; i++)
     {
         bitarray_out[i] = g_transmission_buffer[i];
         g_transmission_buffer[i] = 0;
+#ifdef SOFT_DECISION
+        if (unreliable_out != 0)
+            unreliable_out[i] = g_transmission_buffer[num_bytes + i];
+        g_transmission_buffer[num_bytes + i] = 0;
+#endif
     }
+#ifndef SOFT_DECISION
+    (void)unreliable_out;
+#endif
     *bitarray_length_out = g_transmission_length;
 
+#ifdef DUAL_SENSOR
+    g_received_sensors = sensors & (uint8_t)~ALTERNATE_TRANSMISSION_FLAG;
+    // Until the caller says otherwise by rejecting it
+    g_previous_transmission_used = true;
+#endif
+
     // Set the transmission length to zero to indicate the transmission buffer can be overwritten
     g_transmission_length = 0;
 
     return true;
 }
 
+bool irTransceiver_receive(uint8_t* bitarray_out, uint8_t bitarray_max_length, uint8_t* bitarray_length_out)
+{
+    return takeTransmission(bitarray_out, 0, bitarray_max_length, bitarray_length_out);
+}
+
 void irTransceiver_transmit8WithCRC(uint8_t data)
 {
     uint8_t transmission[] = {data, crc(data) << (8 - CRC_LENGTH)};
@@ -146,18 +274,86 @@ bool irTransceiver_receive8WithCRC(uint8_t* data_out)
         return false;
 
     if (num_bits != 8 + CRC_LENGTH)
-        return false;
+        return rejectTransmission(IR_RECEIVE_FAILURE_UNEXPECTED_LENGTH);
 
     uint8_t data = transmission[0];
 
     uint8_t actual_crc = transmission[1] >> (8 - CRC_LENGTH);
     uint8_t expected_crc = crc(data);
 
-    bool crc_matches = expected_crc == actual_crc;
-    if (crc_matches)
-    {
-        *data_out = data;
-    }
+    if (expected_crc != actual_crc)
+        return rejectTransmission(IR_RECEIVE_FAILURE_CRC_MISMATCH);
+
+    *data_out = data;
+    return true;
+}
+
+void irTransceiver_transmit8WithFEC(uint8_t data)
+{
+    uint8_t transmission[FEC_CODEWORD_BYTES];
+    fec_encode8(data, transmission);
+    irTransceiver_transmit(transmission, FEC_CODEWORD_LENGTH);
+}
+
+bool irTransceiver_receive8WithFEC(uint8_t* data_out)
+{
+    uint8_t transmission[FEC_CODEWORD_BYTES];
+    uint8_t unreliable[FEC_CODEWORD_BYTES];
+    uint8_t num_bits;
+    if (!takeTransmission(transmission, unreliable, FEC_CODEWORD_LENGTH, &num_bits))
+        return false;
 
-    return crc_matches;
+    if (num_bits != FEC_CODEWORD_LENGTH)
+        return rejectTransmission(IR_RECEIVE_FAILURE_UNEXPECTED_LENGTH);
+
+#ifdef SOFT_DECISION
+    // Treat the unreliable bits as erasures, which lets more errors be corrected
+    uint8_t corrected_count = fec_decode8WithErasures(transmission, unreliable, data_out);
+#else
+    (void)unreliable;
+    uint8_t corrected_count = fec_decode8(transmission, data_out);
+#endif
+    if (corrected_count == FEC_UNCORRECTABLE)
+        return rejectTransmission(IR_RECEIVE_FAILURE_UNCORRECTABLE);
+
+    return true;
+}
+
+uint8_t irTransceiver_getReceivedSensors()
+{
+    return g_received_sensors;
+}
+
+uint16_t irTransceiver_getReceiveFailureCount(ir_receive_failure_t cause)
+{
+    return g_receive_failure_counts[cause];
+}
+
+void irTransceiver_resetReceiveFailureCounts()
+{
+    for (uint8_t cause = 0; cause < IR_RECEIVE_FAILURE_COUNT; cause++)
+        g_receive_failure_counts[cause] = 0;
+}
+
+void irTransceiver_requestTelemetry()
+{
+    uint8_t command = TELEMETRY_REQUEST_COMMAND;
+    i2cMaster_write(TRANSCEIVER_ADDRESS, &command, 1);
+}
+
+bool irTransceiver_getTelemetry(ir_receiver_telemetry_t* telemetry_out)
+{
+    if (!g_telemetry_available)
+        return false;
+
+    *telemetry_out = g_telemetry;
+    g_telemetry_available = false;
+
+    return true;
+}
+
+void irTransceiver_resetTelemetry()
+{
+    uint8_t command = TELEMETRY_RESET_COMMAND;
+    i2cMaster_write(TRANSCEIVER_ADDRESS, &command, 1);
 }
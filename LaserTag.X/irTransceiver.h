@@ -1,20 +1,65 @@
 #ifndef IRTRANSCEIVER_H
 #define IRTRANSCEIVER_H
 
+#include "../LaserTagUtils.X/irLinkProtocol.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
+// Why a received transmission was discarded, after the causes the transceiver detects and reports. See
+// ir_receive_failure_t in irLinkProtocol.h, whose values these share
+enum
+{
+    // The transmission was received whole, but its CRC didn't match its data
+    IR_RECEIVE_FAILURE_CRC_MISMATCH = TRANSCEIVER_RECEIVE_FAILURE_COUNT,
+    // The transmission was received whole, but wasn't the length the receiving function expected
+    IR_RECEIVE_FAILURE_UNEXPECTED_LENGTH,
+    // The transmission was received whole, but had more bit errors than forward error correction can correct
+    IR_RECEIVE_FAILURE_UNCORRECTABLE,
+    IR_RECEIVE_FAILURE_COUNT
+};
+
+// Flags for the transceiver's sensors. See irTransceiver_getReceivedSensors
+#define IR_TRANSCEIVER_SENSOR_1 (SENSOR_1_FLAG)
+#define IR_TRANSCEIVER_SENSOR_2 (SENSOR_2_FLAG)
+
 void irTransceiver_eventHandler(void);
 
 void irTransceiver_transmit(uint8_t* bitarray, uint8_t bitarray_length);
 // Get a received transmission, if available. Returns the bits and the number of bits as two out parameters. Returns
 // true if a transmission was returned, false otherwise. Skips and discards transmissions that are longer than
-// bitarray_max_length
+// bitarray_max_length, counting them as IR_RECEIVE_FAILURE_UNEXPECTED_LENGTH
 bool irTransceiver_receive(uint8_t* bitarray_out, uint8_t bitarray_max_length, uint8_t* bitarray_length_out);
 
 // Same as transmit and receive, except transmits/receives 8 bits of data with a CRC. Received transmissions for which
-// the CRC doesn't match the data are discarded and not reported
+// the CRC doesn't match the data are discarded and not returned, but are counted as IR_RECEIVE_FAILURE_CRC_MISMATCH
 void irTransceiver_transmit8WithCRC(uint8_t data);
 bool irTransceiver_receive8WithCRC(uint8_t* data_out);
 
+// Same as transmit and receive, except transmits/receives 8 bits of data as a forward error correction codeword. See
+// fec.h. Up to two flipped bits are corrected, or more with SOFT_DECISION if the transceiver flagged them as
+// unreliable. Received transmissions with more errors than that are discarded and not returned, but are counted as
+// IR_RECEIVE_FAILURE_UNCORRECTABLE
+void irTransceiver_transmit8WithFEC(uint8_t data);
+bool irTransceiver_receive8WithFEC(uint8_t* data_out);
+
+// Returns the IR_TRANSCEIVER_SENSOR_ flags for the sensors that received the transmission most recently returned by a
+// receive function, e.g. to tell which side of a vest was hit. Both are set if both sensors received it. Always
+// IR_TRANSCEIVER_SENSOR_1 unless the transceiver has two sensors. If its sensors decoded a transmission differently,
+// the second sensor's version is only returned if the first's was discarded by receive8WithCRC or receive8WithFEC
+uint8_t irTransceiver_getReceivedSensors(void);
+
+// Returns the number of received transmissions discarded for the given cause since the counts were last reset. Counts
+// stop at UINT16_MAX rather than wrapping
+uint16_t irTransceiver_getReceiveFailureCount(ir_receive_failure_t cause);
+void irTransceiver_resetReceiveFailureCounts(void);
+
+// Ask the transceiver for its telemetry counts. The report arrives asynchronously, through irTransceiver_eventHandler
+void irTransceiver_requestTelemetry(void);
+// Returns true and copies the most recent telemetry report into the out parameter if one has arrived since the last
+// call. Returns false otherwise
+bool irTransceiver_getTelemetry(ir_receiver_telemetry_t* telemetry_out);
+// Reset the transceiver's telemetry counts, e.g. at the start of a game
+void irTransceiver_resetTelemetry(void);
+
 #endif /* IRTRANSCEIVER_H */
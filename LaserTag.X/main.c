@@ -98,8 +98,9 @@ static void testLEDDriver()
     // Reset all registers. No surprises
     LEDDriver_reset();
 
+    // The values stay in program memory. LEDDriver copies them straight into the I2C queue
     {
-        uint8_t data[36] = {
+        static const uint8_t data[LED_DRIVER_CHANNEL_COUNT] = {
             255,  // Bar: Red
             255,  // Bar: Red
             255,  // Bar: Red
@@ -138,10 +139,10 @@ static void testLEDDriver()
             0     // NONE
         };
 
-        LEDDriver_setPWM(0, data, 36);
+        LEDDriver_setPWM(0, data, LED_DRIVER_CHANNEL_COUNT);
     }
     {
-        uint8_t data[36] = {
+        static const uint8_t data[LED_DRIVER_CHANNEL_COUNT] = {
             0b001,  // Bar: Red
             0b001,  // Bar: Red
             0b001,  // Bar: Red
@@ -180,7 +181,7 @@ static void testLEDDriver()
             0       // NONE
         };
 
-        LEDDriver_setControl(0, data, 36);
+        LEDDriver_setControl(0, data, LED_DRIVER_CHANNEL_COUNT);
     }
 
     LEDDriver_flushChanges();
@@ -255,7 +256,7 @@ int main(void)
         irTransceiver_eventHandler();
 
         uint8_t received_data;
-        if (irTransceiver_receive8WithCRC(&received_data))
+        if (irTransceiver_receive8WithFEC(&received_data))
         {
 #ifdef DISPLAY_RECEIVED_DATA
             setBarDisplay1(received_data);
@@ -355,7 +356,7 @@ void shoot(void)
     g_shot_data_to_send = (g_shot_data_to_send >> 1) | ((TMR2 & 1) << 7);
 #endif
 
-    irTransceiver_transmit8WithCRC(g_shot_data_to_send);
+    irTransceiver_transmit8WithFEC(g_shot_data_to_send);
 
 #ifdef COUNT_DROPPED_TRANSMISSIONS
 #ifdef DISPLAY_DROP_COUNT
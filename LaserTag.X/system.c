@@ -1,7 +1,9 @@
 #include "system.h"
 
+#include "../LaserTagUtils.X/fec.h"
 #include "LEDs.h"
 #include "crc.h"
+#include "error.h"
 #include "i2cMaster.h"
 #include "realTimeClock.h"
 
@@ -24,6 +26,8 @@ void configureSystem(void)
     initializeLEDs();
     initializeRTC();
     initializeCRC();
+    if (!fec_tablesAreValid())
+        fatal(ERROR_FEC_TABLES_OUT_OF_DATE);
     i2cMaster_initialize();
 
     LATA = 0b00110000;
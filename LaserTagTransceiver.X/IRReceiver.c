@@ -2,8 +2,9 @@
 #include <xc.h>
 
 #include "../LaserTagUtils.X/bitArray.h"
-#include "../LaserTagUtils.X/queue.h"
+#include "../LaserTagUtils.X/typedQueue.h"
 #include "IRReceiverStats.h"
+#include "clc.h"
 #include "error.h"
 #include "pins.h"
 #include "transmissionConstants.h"
@@ -27,8 +28,13 @@
  *    - Automatic: SMTxTMR is latched into SMTxCPW
  *    - Automatic: SMTxTMR is reset (but not stopped)
  *    - Automatic: Sets SMTxPWAIF (interrupt)
- *    - Interrupt handler: records SMTxCPW as the last HIGH pulse width and
- *          SMTxCPR as the last LOW pulse width
+ *    - Interrupt handler: decodes SMTxCPW, the width of the HIGH pulse that
+ *          just ended, as a bit and appends it to the transmission in progress,
+ *          after checking SMTxCPR, the width of the gap before it. With
+ *          MULTI_LEVEL_SYMBOLS, every second pulse is decoded along with the
+ *          one before it as a symbol of three bits. With GAP_MODULATION, the
+ *          gap before the pulse is decoded as a bit too, unless the pulse
+ *          before it wasn't data
  *
  * On SMTxTMR period match:
  *    - Automatic: halt timer until reset
@@ -59,13 +65,30 @@
  *
  * If a period match occurs, we know there was silence on the transmission line
  * for at least the duration determined by the period register. We handle the
- * period match interrupt by setting a global boolean indicating that a
- * transmission is available and turning the timer back on.
+ * period match interrupt by queueing the transmission in progress, if it is
+ * valid, for the main loop to collect, and turning the timer back on. With
+ * FRAME_HEADER, a transmission is queued as soon as its declared length has
+ * arrived instead, and any more pulses are ignored until the long gap.
  *
  * If the timer is turned off by a period match and an active pulse begins and
  * ends before the timer is turned on again, then the following gap will not be
  * measured by this timer. This is unlikely, since we're turning the timer back
  * on in the interrupt handler for it being turned off.
+ *
+ *
+ * With DUAL_SENSOR, SMT2 measures a second sensor in the same way, and each
+ * sensor's pulses are decoded into a transmission of its own. There's no third
+ * timer free to detect the second sensor's long gaps, so CLC3 combines the two
+ * sensors into one signal, active while either sensor is, and TMR4 detects long
+ * gaps in that instead. A long gap then ends both sensors' transmissions at
+ * once, which is when they're compared, so that a transmission both sensors
+ * received is queued once rather than twice.
+ *
+ * Since the gap detector can't tell the sensors apart, if one sensor receives a
+ * transmission while the other is still receiving a different one, the first
+ * sensor's transmission doesn't end until the other's does. If the first sensor
+ * receives any of the later transmission in the meantime, the gap before it is
+ * too long to be a pulse gap, and the first sensor's transmission is discarded.
  */
 
 #define SMT1_CLOCK_FREQ 500000
@@ -116,6 +139,71 @@ static void configureSMT1(void)
     SMT1GO = 1;
 }
 
+#ifdef DUAL_SENSOR
+// Same as configureSMT1, except for the second sensor. SMT2 runs at the same frequency, so its measurements are in SMT1
+// cycles too
+static void configureSMT2(void)
+{
+    SMT2GO = 0;
+    SMT2CON0bits.EN = 1;
+    // High and Low Measurement, repeated
+    SMT2CON1bits.MODE = 0b0011;
+    SMT2REPEAT = 1;
+
+    // MFINTOSC, 1:1 prescaler
+    SMT2CLK = 0b101;
+    SMT2CON0bits.SMT2PS = 0b00;
+
+    // Signal input source: pin selected by SMT2SIGPPS, which is the second IR receiver pin, active-low
+    SMT2SIG = 0b00000;
+    SMT2SIGPPS = PPS_IN_VAL_IR_RECEIVER_2;
+    TRIS_IR_RECEIVER_2 = 1;
+    SMT2CON0bits.SPOL = 1;
+
+    // Halt on period match, keeping measurements within 8 bits
+    SMT2CON0bits.STP = 1;
+    SMT2PR = 0xFE;
+    SMT2IE = 0;
+
+    // Enable falling edge (end of pulse) interrupts
+    SMT2PWAIE = 1;
+
+    SMT2TMR = 0;
+    SMT2GO = 1;
+}
+
+static void configureCLC3(void)
+{
+    // Take the two IR receivers as inputs
+    CLC3SEL0 = CLC_SOURCE_CLCIN2;
+    CLC3SEL1 = CLC_SOURCE_CLCIN3;
+    PPS_IN_REG_CLCIN2 = PPS_IN_VAL_IR_RECEIVER;
+    PPS_IN_REG_CLCIN3 = PPS_IN_VAL_IR_RECEIVER_2;
+
+    // Gate 0 receives CLCIN2 and gate 1 receives CLCIN3. Neither the inputs nor the outputs are inverted
+    CLC3GLS0 = 0b00000010;
+    LC3G1POL = 0;
+    CLC3GLS1 = 0b00001000;
+    LC3G2POL = 0;
+    // Gates 2 and 3 receive nothing, and always output HIGH
+    CLC3GLS2 = 0;
+    LC3G3POL = 1;
+    CLC3GLS3 = 0;
+    LC3G4POL = 1;
+
+    // The receivers are active-low, so ANDing them gives a signal that is active while either of them is
+    CLC3CONbits.LC3MODE = CLC_LOGIC_FUNCTION_4IN_AND;
+    LC3POL = 0;
+
+    // TMR4 can only be reset by a pin, so output the combined signal on a pin for TMR4 to read back. The pin stays an
+    // output, as it can still be read
+    PPS_OUT_REG_IR_RECEIVERS_COMBINED = PPS_OUT_VAL_LC3_out;
+    TRIS_IR_RECEIVERS_COMBINED = 0;
+
+    LC3EN = 1;
+}
+#endif
+
 #define TMR4_CLOCK_FREQ 500000
 // Ratio between TMR4 clock frequency and transmission carrier wave frequency.
 // Assumes they divide evenly
@@ -128,11 +216,135 @@ static void configureSMT1(void)
 // in 8 bits
 typedef uint8_t SMT1_t;
 
-// Double the maximum transmission length in bits, plus one
-#define INCOMING_PULSE_WIDTHS_STORAGE_SIZE ((MAX_TRANSMISSION_LENGTH) << 1) + 1
-static uint8_t g_incoming_pulse_widths_storage[INCOMING_PULSE_WIDTHS_STORAGE_SIZE];
-// Active and inactive pulse widths
-static queue_t g_incoming_pulse_widths;
+// A received transmission, decoded into bits by the interrupt handlers
+typedef struct
+{
+    // Length of the transmission in bits
+    uint8_t length;
+    uint8_t data[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+#ifdef SOFT_DECISION
+    // A flag for each bit of the data, set if the bit is unreliable
+    uint8_t unreliable[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+#endif
+#ifdef DUAL_SENSOR
+    // IR_RECEIVER_SENSOR_ flags for the sensors that received the transmission
+    uint8_t sensors;
+#endif
+} received_transmission_t;
+
+// A power of two so that the queue can wrap its indices with a mask, so it holds one fewer transmission than this. The
+// interrupt handlers decode each transmission in place in the next free slot, and only push it once it is complete, so
+// a slow main loop costs whole transmissions rather than overflowing part way through one. With DUAL_SENSOR, both
+// sensors can be receiving at once, so each decodes into a buffer of its own instead, which is copied into the queue
+// once both have finished. The handlers are the producer and irReceiver_tryGetTransmission is the consumer. The
+// handlers can't interrupt each other, so they count as one producer
+#define RECEIVED_TRANSMISSIONS_QUEUE_LENGTH 4
+
+TYPED_QUEUE_DEFINE(received_transmissions_queue_t, receivedTransmissionsQueue, received_transmission_t,
+                   RECEIVED_TRANSMISSIONS_QUEUE_LENGTH)
+
+static received_transmissions_queue_t g_received_transmissions;
+
+// The number of transmissions discarded for each cause, modulo 256. Each count is written either only by the interrupt
+// handlers or, for IR_RECEIVE_FAILURE_DROPPED, only by the main loop, and never reset, so that they can be read without
+// disabling interrupts
+static volatile uint8_t g_failure_counts[TRANSCEIVER_RECEIVE_FAILURE_COUNT];
+
+// Written by the interrupt handlers, except transmissions_collected, which is written by irReceiver_tryGetTransmission.
+// The main loop can't read a 16-bit count in one instruction, so it masks the interrupts to read them
+static volatile ir_receiver_telemetry_t g_telemetry;
+
+#ifdef TRAINING_PREAMBLE
+// Pulse width decision thresholds for the transmission in progress, in SMT1 cycles, measured from its preamble. A pulse
+// is valid if it is strictly between the lower and upper bounds, and is a one if it is at least the threshold. With
+// MULTI_LEVEL_SYMBOLS, it's a two if it is at least the upper threshold
+typedef struct
+{
+    uint8_t lower_bound;
+    uint8_t threshold;
+#ifdef MULTI_LEVEL_SYMBOLS
+    uint8_t upper_threshold;
+#endif
+    uint8_t upper_bound;
+#ifdef SOFT_DECISION
+    // How close to a bound a pulse can be, inside or out, before it's unreliable
+    uint8_t soft_decision_margin;
+#endif
+} decision_thresholds_t;
+#endif
+
+// The state of decoding one sensor's transmission in progress
+typedef struct
+{
+    // The transmission being decoded, in its reserved slot in the queue, or in buffer with DUAL_SENSOR. Null before its
+    // first pulse
+    volatile received_transmission_t* transmission;
+    // The bits of the transmission in progress that don't yet fill a whole byte, in the least significant bits. Bits
+    // are shifted in one at a time and written out a byte at a time, rather than set in the transmission by their index
+    uint8_t partial_byte;
+#ifdef SOFT_DECISION
+    // The reliability flags for the bits in partial_byte
+    uint8_t partial_unreliable;
+#endif
+    // True if the rest of the transmission in progress should be ignored, because it had an invalid pulse or gap width
+    // or there was no free slot to decode it into, or with FRAME_HEADER, because it has already been queued. Cleared at
+    // the end of the transmission
+    bool invalid;
+#ifdef TRAINING_PREAMBLE
+    // The number of preamble pulses received so far in the transmission in progress
+    uint8_t training_pulse_count;
+    // The total widths of the preamble's zero and one pulses received so far
+    uint16_t training_zero_widths;
+    uint16_t training_one_widths;
+    decision_thresholds_t thresholds;
+#endif
+#ifdef FRAME_HEADER
+    // The number of header bits received so far in the transmission in progress
+    uint8_t header_bit_count;
+    // While the delimiter is being received, the delimiter bits still to come, from the most significant bit. Then the
+    // length bits received so far, which is the declared length once the whole header has been received
+    uint8_t header;
+#endif
+#ifdef MULTI_LEVEL_SYMBOLS
+    // The level of the first pulse of the symbol in progress, or NO_PULSE_LEVEL before it
+    uint8_t first_level;
+#ifdef SOFT_DECISION
+    // Whether the first pulse of the symbol in progress was unreliable
+    uint8_t first_unreliable;
+#endif
+#endif
+#ifdef GAP_MODULATION
+    // True once the first pulse of the transmission's data has been received, after which every gap is a bit
+    bool gap_is_bit;
+#ifndef FRAME_HEADER
+    // The transmission's first bit, which says whether its last pulse was added to end it rather than being data
+    bool padded;
+#endif
+#endif
+#ifdef DUAL_SENSOR
+    received_transmission_t buffer;
+#endif
+} receive_channel_t;
+
+#ifdef DUAL_SENSOR
+#define RECEIVE_CHANNEL_COUNT 2
+#else
+#define RECEIVE_CHANNEL_COUNT 1
+#endif
+
+// One channel for each sensor, in the order of the IR_RECEIVER_SENSOR_ flags
+static receive_channel_t g_channels[RECEIVE_CHANNEL_COUNT];
+
+#ifdef MULTI_LEVEL_SYMBOLS
+// Stands in for the level of the first pulse of a symbol before it has been received
+#define NO_PULSE_LEVEL 0xFF
+// Stands in for a symbol for a pair of pulse levels that no symbol is sent as
+#define INVALID_SYMBOL 0xFF
+
+// The symbol for each pair of pulse levels, indexed by three times the first pulse's level plus the second's. See
+// SYMBOL_LENGTH
+static const uint8_t g_symbols[9] = {0b000, 0b001, 0b011, 0b010, INVALID_SYMBOL, 0b111, 0b110, 0b100, 0b101};
+#endif
 
 static void configureTMR4(void)
 {
@@ -148,8 +360,13 @@ static void configureTMR4(void)
     // Set external reset signal to pin selected by T4INPPS
     T4RSTbits.RSEL = 0b0000;
 
+#ifdef DUAL_SENSOR
+    // Set external reset signal pin to both IR receivers combined. See configureCLC3
+    T4PPS = PPS_IN_VAL_IR_RECEIVERS_COMBINED;
+#else
     // Set external reset signal pin to the IR receiver pin
     T4PPS = PPS_IN_VAL_IR_RECEIVER;
+#endif
 
     T4PR = MIN_TRANSMISSION_GAP_LENGTH_TMR4_CYCLES;
 
@@ -162,10 +379,42 @@ static void configureTMR4(void)
 
 void receiverStaticAsserts(void);
 
+// Discard the channel's transmission in progress, and count it against the given cause
+static void failTransmission(receive_channel_t* channel, ir_receive_failure_t cause)
+{
+    channel->invalid = true;
+    g_failure_counts[cause]++;
+    g_telemetry.transmissions_discarded++;
+}
+
+// Start afresh with the channel's next transmission, whether the last one was queued or discarded
+static void resetChannel(receive_channel_t* channel)
+{
+    channel->transmission = 0;
+    channel->invalid = false;
+#ifdef TRAINING_PREAMBLE
+    channel->training_pulse_count = 0;
+#endif
+#ifdef FRAME_HEADER
+    channel->header_bit_count = 0;
+    channel->header = (uint8_t)((START_OF_FRAME_DELIMITER) << (8 - (START_OF_FRAME_DELIMITER_LENGTH)));
+#endif
+#ifdef MULTI_LEVEL_SYMBOLS
+    channel->first_level = NO_PULSE_LEVEL;
+#endif
+#ifdef GAP_MODULATION
+    channel->gap_is_bit = false;
+#endif
+}
+
 static void disableReceptionModules(void)
 {
     TMR4ON = 0;
     SMT1CON0bits.EN = 0;
+#ifdef DUAL_SENSOR
+    SMT2CON0bits.EN = 0;
+    LC3EN = 0;
+#endif
 }
 
 void irReceiver_initialize(void)
@@ -173,9 +422,15 @@ void irReceiver_initialize(void)
     receiverStaticAsserts();
 
     configureSMT1();
+#ifdef DUAL_SENSOR
+    configureSMT2();
+    configureCLC3();
+#endif
     configureTMR4();
 
-    g_incoming_pulse_widths = queue_create(g_incoming_pulse_widths_storage, INCOMING_PULSE_WIDTHS_STORAGE_SIZE);
+    receivedTransmissionsQueue_initialize(&g_received_transmissions);
+    for (uint8_t i = 0; i < RECEIVE_CHANNEL_COUNT; i++)
+        resetChannel(&g_channels[i]);
 }
 
 void irReceiver_shutdown(void)
@@ -206,27 +461,665 @@ void irReceiver_shutdown(void)
 #define ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES \
     ((ONE_PULSE_LENGTH_LOWER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10)
 
+#ifdef MULTI_LEVEL_SYMBOLS
+// Twos are only sent with a training preamble, so only have to allow for the receiver's specified bias
+#define TWO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES                                                        \
+    (((TWO_PULSE_LENGTH_MOD_CYCLES)*10 + (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_SPEC_MOD_CYCLES_x10)) \
+     * (SMT1_MOD_FREQ_RATIO) / 10)
+#endif
+
+// Upper and lower bounds of the gaps between pulses, in terms of modulation cycles, 10x the real values. The receiver
+// stretches or shrinks the pulse before a gap, which shrinks or stretches the gap by the same amount
+#define PULSE_GAP_LENGTH_UPPER_BOUND_MOD_CYCLES_x10 \
+    ((PULSE_GAP_LENGTH_MOD_CYCLES)*10 + (RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10))
+#define PULSE_GAP_LENGTH_LOWER_BOUND_MOD_CYCLES_x10 \
+    ((PULSE_GAP_LENGTH_MOD_CYCLES)*10 - (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10))
+
+#define PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES \
+    ((PULSE_GAP_LENGTH_UPPER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10)
+#define PULSE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES \
+    ((PULSE_GAP_LENGTH_LOWER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10)
+
+#ifdef GAP_MODULATION
+// As for a pulse gap, which is a zero, but for a one
+#define ONE_GAP_LENGTH_UPPER_BOUND_MOD_CYCLES_x10 \
+    ((ONE_GAP_LENGTH_MOD_CYCLES)*10 + (RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10))
+#define ONE_GAP_LENGTH_LOWER_BOUND_MOD_CYCLES_x10 \
+    ((ONE_GAP_LENGTH_MOD_CYCLES)*10 - (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10))
+
+#define ONE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES \
+    ((ONE_GAP_LENGTH_UPPER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10)
+#define ONE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES \
+    ((ONE_GAP_LENGTH_LOWER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10)
+
+// Gaps shorter than this are decoded as zeros, and others as ones. Halfway between the windows for a zero and a one
+#define GAP_LENGTH_THRESHOLD_SMT1_CYCLES \
+    (((PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES) + (ONE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES)) >> 1)
+
+// The longest a gap within a transmission can measure, in SMT1 cycles
+#define LONGEST_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES (ONE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES)
+#else
+#define LONGEST_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES (PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES)
+#endif
+
+#ifdef SOFT_DECISION
+// For decoding with fixed windows, how close to a window's bound a pulse can be, inside or out, before it's unreliable,
+// in SMT1 cycles. An eighth of the nominal difference between a zero and a one
+#define SOFT_DECISION_MARGIN_SMT1_CYCLES (((PULSE_LENGTH_MIN_DIFF_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO)) >> 3)
+// Likewise for gaps, which are always decoded with fixed windows
+#define GAP_SOFT_DECISION_MARGIN_SMT1_CYCLES (((GAP_LENGTH_MIN_DIFF_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO)) >> 3)
+#else
+#define SOFT_DECISION_MARGIN_SMT1_CYCLES 0
+#define GAP_SOFT_DECISION_MARGIN_SMT1_CYCLES 0
+#endif
+
+// True if the pulse length is strictly between the bounds, or less than margin outside of them. Sets *unreliable_out
+// to 1 if it's less than margin from either bound, inside or out, and to 0 otherwise. With a margin of zero, this is a
+// plain bounds check and no pulse is unreliable
+static bool isInWindow(uint8_t pulse_length, uint8_t lower_bound, uint8_t upper_bound, uint8_t margin,
+                       uint8_t* unreliable_out)
+{
+    if (pulse_length + margin <= lower_bound || pulse_length >= upper_bound + margin)
+        return false;
+
+    *unreliable_out = (pulse_length < lower_bound + margin || pulse_length + margin > upper_bound) ? 1 : 0;
+    return true;
+}
+
+#ifdef TRAINING_PREAMBLE
+// The smallest difference between the measured zero and one widths for a preamble to be trusted, in SMT1 cycles. Half
+// the nominal difference
+#define TRAINING_MIN_DIFF_SMT1_CYCLES (((PULSE_LENGTH_MIN_DIFF_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO)) >> 1)
+
+// Measure one pulse of the channel's preamble. Once the whole preamble has been measured, sets the decision thresholds
+// for the rest of the transmission, or marks the transmission invalid if the preamble doesn't look like one
+static void trainOnPulse(receive_channel_t* channel, uint8_t pulse_length)
+{
+    if (channel->training_pulse_count == 0)
+    {
+        channel->training_zero_widths = 0;
+        channel->training_one_widths = 0;
+    }
+
+    // The preamble alternates zero and one pulses, starting with zero
+    if ((channel->training_pulse_count & 1) == 0)
+        channel->training_zero_widths += pulse_length;
+    else
+        channel->training_one_widths += pulse_length;
+
+    channel->training_pulse_count++;
+    if (channel->training_pulse_count != TRAINING_PREAMBLE_LENGTH)
+        return;
+
+    // Average the two pulses of each width
+    uint8_t zero_width = (uint8_t)(channel->training_zero_widths >> 1);
+    uint8_t one_width = (uint8_t)(channel->training_one_widths >> 1);
+
+    if (one_width <= zero_width || one_width - zero_width < TRAINING_MIN_DIFF_SMT1_CYCLES)
+    {
+        // Not a preamble, e.g. noise or the tail of another transmission
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_PREAMBLE);
+        return;
+    }
+
+    // Split the difference between the widths, and accept pulses up to the same distance beyond either of them
+    decision_thresholds_t* thresholds = &channel->thresholds;
+    uint8_t half_diff = (one_width - zero_width) >> 1;
+    thresholds->lower_bound = zero_width > half_diff ? zero_width - half_diff : 0;
+    thresholds->threshold = zero_width + half_diff;
+#ifdef MULTI_LEVEL_SYMBOLS
+    // The preamble has no twos, but a two is as much longer than a one as a one is than a zero
+    uint8_t diff = one_width - zero_width;
+    uint8_t two_width = one_width < 0xFF - diff ? one_width + diff : 0xFF;
+    thresholds->upper_threshold = one_width < 0xFF - half_diff ? one_width + half_diff : 0xFF;
+    thresholds->upper_bound = two_width < 0xFF - half_diff ? two_width + half_diff : 0xFF;
+#else
+    thresholds->upper_bound = one_width < 0xFF - half_diff ? one_width + half_diff : 0xFF;
+#endif
+#ifdef SOFT_DECISION
+    thresholds->soft_decision_margin = half_diff >> 2;
+#endif
+}
+
+// Decode a pulse width as a level, which is the bit it's sent as unless MULTI_LEVEL_SYMBOLS. Returns false if it's an
+// invalid pulse width. Sets *unreliable_out as isInWindow does
+static bool tryDecodePulseLength(receive_channel_t* channel, uint8_t pulse_length, uint8_t* level_out,
+                                 uint8_t* unreliable_out)
+{
+    decision_thresholds_t* thresholds = &channel->thresholds;
+#ifdef SOFT_DECISION
+    uint8_t margin = thresholds->soft_decision_margin;
+#else
+    uint8_t margin = 0;
+#endif
+
+    if (pulse_length < thresholds->threshold)
+    {
+        *level_out = 0;
+        return isInWindow(pulse_length, thresholds->lower_bound, thresholds->threshold, margin, unreliable_out);
+    }
+
+#ifdef MULTI_LEVEL_SYMBOLS
+    if (pulse_length < thresholds->upper_threshold)
+    {
+        *level_out = 1;
+        return isInWindow(pulse_length, thresholds->threshold - 1, thresholds->upper_threshold, margin,
+                          unreliable_out);
+    }
+
+    *level_out = 2;
+    return isInWindow(pulse_length, thresholds->upper_threshold - 1, thresholds->upper_bound, margin, unreliable_out);
+#else
+    *level_out = 1;
+    return isInWindow(pulse_length, thresholds->threshold - 1, thresholds->upper_bound, margin, unreliable_out);
+#endif
+}
+
+// True if the pulse is too long to be a one, or with MULTI_LEVEL_SYMBOLS a two, as when it's two pulses that ran
+// together
+static bool isOverlongPulse(receive_channel_t* channel, uint8_t pulse_length)
+{
+    return pulse_length >= channel->thresholds.upper_bound;
+}
+#else
+// Pulses shorter than this are decoded as zeros, and others as ones. Halfway between the windows for a zero and a one
+#define PULSE_LENGTH_THRESHOLD_SMT1_CYCLES \
+    (((ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES) + (ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES)) >> 1)
+
+// Decode a pulse width as a bit. Returns false if it's an invalid pulse width. Sets *unreliable_out as isInWindow does.
+// Every channel has the same windows
+static bool tryDecodePulseLength(receive_channel_t* channel, uint8_t pulse_length, uint8_t* bit_out,
+                                 uint8_t* unreliable_out)
+{
+    (void)channel;
+
+    if (pulse_length < PULSE_LENGTH_THRESHOLD_SMT1_CYCLES)
+    {
+        *bit_out = 0;
+        return isInWindow(pulse_length, ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES,
+                          ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES, SOFT_DECISION_MARGIN_SMT1_CYCLES, unreliable_out);
+    }
+
+    *bit_out = 1;
+    return isInWindow(pulse_length, ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES, ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES,
+                      SOFT_DECISION_MARGIN_SMT1_CYCLES, unreliable_out);
+}
+
+// True if the pulse is too long to be a one, as when it's two pulses that ran together
+static bool isOverlongPulse(receive_channel_t* channel, uint8_t pulse_length)
+{
+    (void)channel;
+    return pulse_length >= ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES;
+}
+#endif
+
+#ifdef GAP_MODULATION
+// Decode a gap width as a bit. Returns false if it's an invalid gap width. Sets *unreliable_out as isInWindow does.
+// Every channel has the same windows
+static bool tryDecodeGapLength(uint8_t gap_length, uint8_t* bit_out, uint8_t* unreliable_out)
+{
+    if (gap_length < GAP_LENGTH_THRESHOLD_SMT1_CYCLES)
+    {
+        *bit_out = 0;
+        return isInWindow(gap_length, PULSE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES,
+                          PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES, GAP_SOFT_DECISION_MARGIN_SMT1_CYCLES,
+                          unreliable_out);
+    }
+
+    *bit_out = 1;
+    return isInWindow(gap_length, ONE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES, ONE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES,
+                      GAP_SOFT_DECISION_MARGIN_SMT1_CYCLES, unreliable_out);
+}
+#endif
+
+#ifdef FRAME_HEADER
+// Read one bit of the channel's frame header. Marks the transmission invalid as soon as a bit doesn't match the
+// delimiter, or once the whole header has been read if the declared length is out of range
+static void readHeaderBit(receive_channel_t* channel, uint8_t bit)
+{
+    uint8_t header = channel->header;
+    uint8_t count = channel->header_bit_count;
+
+    if (count < START_OF_FRAME_DELIMITER_LENGTH && bit != (header >> 7))
+    {
+        // Most likely noise, or the tail of a transmission whose start was missed
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_HEADER);
+        return;
+    }
+
+    // The delimiter's bits are shifted out as they're matched, leaving zero to shift the length bits into
+    header = (uint8_t)(header << 1) | (count < START_OF_FRAME_DELIMITER_LENGTH ? 0 : bit);
+    count++;
+
+    channel->header = header;
+    channel->header_bit_count = count;
+
+    if (count == FRAME_HEADER_LENGTH && (header == 0 || header > MAX_TRANSMISSION_LENGTH))
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_HEADER);
+}
+
+// True if the channel's transmission in progress has all of its declared length
+static bool isComplete(receive_channel_t* channel)
+{
+    return channel->header_bit_count == FRAME_HEADER_LENGTH && channel->transmission->length == channel->header;
+}
+
+static void completeTransmission(receive_channel_t* channel);
+#endif
+
+// Append one decoded bit to the channel's transmission in progress, or with FRAME_HEADER, to its header while that's
+// still being received
+static void decodeBit(receive_channel_t* channel, uint8_t bit, uint8_t unreliable)
+{
+#if defined(MULTI_LEVEL_SYMBOLS) || defined(GAP_MODULATION)
+    // An earlier bit from the same pulse may have discarded or completed the transmission
+    if (channel->invalid)
+        return;
+#endif
+
+#ifdef FRAME_HEADER
+    if (channel->header_bit_count != FRAME_HEADER_LENGTH)
+    {
+        readHeaderBit(channel, bit);
+        return;
+    }
+#ifdef DUAL_SENSOR
+    // The transmission is complete and waiting for the other sensor's copy, so anything after it, such as the padding
+    // at the end of its last symbol, isn't part of it
+    if (isComplete(channel))
+        return;
+#endif
+#endif
+
+    volatile received_transmission_t* transmission = channel->transmission;
+    uint8_t length = transmission->length;
+
+    // If we're already at max length and about to add another bit, the transmission has probably run into another one
+    if (length == MAX_TRANSMISSION_LENGTH)
+    {
+        failTransmission(channel, IR_RECEIVE_FAILURE_TOO_LONG);
+        g_telemetry.too_long_transmissions++;
+        return;
+    }
+
+    channel->partial_byte = (uint8_t)(channel->partial_byte << 1) | bit;
+#ifdef SOFT_DECISION
+    channel->partial_unreliable = (uint8_t)(channel->partial_unreliable << 1) | unreliable;
+#else
+    (void)unreliable;
+#endif
+    length++;
+
+    if ((length & 0b111) == 0)
+    {
+        transmission->data[(length - 1) >> 3] = channel->partial_byte;
+#ifdef SOFT_DECISION
+        transmission->unreliable[(length - 1) >> 3] = channel->partial_unreliable;
+#endif
+    }
+
+    transmission->length = length;
+
+#ifdef FRAME_HEADER
+    if (length == channel->header)
+        completeTransmission(channel);
+#endif
+}
+
+#ifdef MULTI_LEVEL_SYMBOLS
+// Decode the second pulse of a symbol, given its level, along with the first, and append the symbol's bits to the
+// channel's transmission in progress. A pulse one level off changes one bit of the symbol, but which one depends on
+// the other pulse, so if either pulse is unreliable, every bit of the symbol is flagged
+static void decodeSymbol(receive_channel_t* channel, uint8_t level, uint8_t unreliable)
+{
+    uint8_t first_level = channel->first_level;
+    channel->first_level = NO_PULSE_LEVEL;
+
+    uint8_t symbol = g_symbols[(uint8_t)(first_level << 1) + first_level + level];
+    if (symbol == INVALID_SYMBOL)
+    {
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_PULSE);
+        return;
+    }
+
+#ifdef SOFT_DECISION
+    unreliable |= channel->first_unreliable;
+#endif
+
+    decodeBit(channel, (symbol >> 2) & 1, unreliable);
+    decodeBit(channel, (symbol >> 1) & 1, unreliable);
+    decodeBit(channel, symbol & 1, unreliable);
+}
+#endif
+
+// Decode one pulse width and append its bit, or with MULTI_LEVEL_SYMBOLS the bits of the symbol it finishes, to the
+// channel's transmission in progress. Takes the width of the gap before the pulse too, which is checked unless this is
+// the first pulse of the transmission, and with GAP_MODULATION, is decoded as the bit before the pulse's
+static void decodePulse(receive_channel_t* channel, uint8_t gap_length, uint8_t pulse_length)
+{
+#ifdef GAP_MODULATION
+    // Only read if the gap was decoded, but the compiler can't tell
+    uint8_t gap_bit = 0;
+    uint8_t gap_unreliable = 0;
+#endif
+
+    // Don't bother decoding the pulse if the transmission is being discarded
+    if (channel->invalid)
+        return;
+
+    volatile received_transmission_t* transmission = channel->transmission;
+    if (transmission == 0)
+    {
+#ifdef DUAL_SENSOR
+        // This is the first pulse of a transmission. It's copied into the queue once it's complete
+        transmission = &channel->buffer;
+#else
+        // This is the first pulse of a transmission. Decode it straight into the next free slot of the queue
+        transmission = receivedTransmissionsQueue_reserve(&g_received_transmissions);
+        if (transmission == 0)
+        {
+            // The main loop hasn't collected the previous transmissions, so there's nowhere to put this one
+            failTransmission(channel, IR_RECEIVE_FAILURE_NO_FREE_SLOT);
+            g_telemetry.queue_overflows++;
+            return;
+        }
+#endif
+
+        transmission->length = 0;
+        channel->transmission = transmission;
+    }
+#ifdef GAP_MODULATION
+    else if (channel->gap_is_bit)
+    {
+        if (!tryDecodeGapLength(gap_length, &gap_bit, &gap_unreliable))
+        {
+            // As with a pulse gap, one that's too short was probably partly covered by another transmitter's pulse
+            failTransmission(channel, gap_length < GAP_LENGTH_THRESHOLD_SMT1_CYCLES ? IR_RECEIVE_FAILURE_OVERLAP
+                                                                                     : IR_RECEIVE_FAILURE_INVALID_GAP);
+            return;
+        }
+    }
+#endif
+    else if (gap_length <= PULSE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES)
+    {
+        // Too short for our own gap, so probably part of it was covered by another transmitter's pulse
+        failTransmission(channel, IR_RECEIVE_FAILURE_OVERLAP);
+        return;
+    }
+    else if (gap_length >= PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES)
+    {
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_GAP);
+        return;
+    }
+
+#ifdef TRAINING_PREAMBLE
+    if (channel->training_pulse_count != TRAINING_PREAMBLE_LENGTH)
+    {
+        trainOnPulse(channel, pulse_length);
+        return;
+    }
+#endif
+
+    uint8_t level;
+    uint8_t unreliable;
+    if (!tryDecodePulseLength(channel, pulse_length, &level, &unreliable))
+    {
+        // Invalid pulse width. Something has gone wrong, so we're going to ignore this transmission. A pulse longer
+        // than the longest level is most likely our pulse and another transmitter's overlapping
+        failTransmission(channel, isOverlongPulse(channel, pulse_length) ? IR_RECEIVE_FAILURE_OVERLAP
+                                                                         : IR_RECEIVE_FAILURE_INVALID_PULSE);
+        return;
+    }
+
+#ifdef GAP_MODULATION
+    if (channel->gap_is_bit)
+    {
+        decodeBit(channel, gap_bit, gap_unreliable);
+    }
+    else
+    {
+        // The first pulse of the data. The gap after it, and after every later pulse, is a bit too
+        channel->gap_is_bit = true;
+#ifndef FRAME_HEADER
+        channel->padded = level != 0;
+        return;
+#endif
+    }
+#endif
+
+#ifdef MULTI_LEVEL_SYMBOLS
+    if (channel->first_level == NO_PULSE_LEVEL)
+    {
+        // Wait for the symbol's second pulse
+        channel->first_level = level;
+#ifdef SOFT_DECISION
+        channel->first_unreliable = unreliable;
+#endif
+        return;
+    }
+
+    decodeSymbol(channel, level, unreliable);
+#else
+    decodeBit(channel, level, unreliable);
+#endif
+}
+
 static void SMT1InterruptHandler()
 {
     if (!(SMT1PWAIF && SMT1PWAIE))
         return;
 
     SMT1PWAIF = 0;
+    g_telemetry.pulses++;
+
+    // We only need to grab the low (L) 8 bits because we've limited the max timer value. SMT1CPR holds the width of
+    // the gap before the pulse. The end of a transmission is detected by TMR4, so any gap seen here is within one
+    decodePulse(&g_channels[0], SMT1CPRL, SMT1CPWL);
+
+    // Imperfect check for interrupt overlap. Another pulse has ended since this one, and if more than one has, a
+    // measurement was overwritten. Rather than halting, discard the transmission, which resyncs at the next long gap.
+    // The flag is left set, so the latest measurement is handled when this handler returns
+    if (SMT1PWAIF && !g_channels[0].invalid)
+        failTransmission(&g_channels[0], IR_RECEIVE_FAILURE_MISSED_PULSE);
+}
+
+#ifdef DUAL_SENSOR
+// Same as SMT1InterruptHandler, except for the second sensor
+static void SMT2InterruptHandler()
+{
+    if (!(SMT2PWAIF && SMT2PWAIE))
+        return;
+
+    SMT2PWAIF = 0;
+    g_telemetry.pulses++;
+
+    decodePulse(&g_channels[1], SMT2CPRL, SMT2CPWL);
+
+    if (SMT2PWAIF && !g_channels[1].invalid)
+        failTransmission(&g_channels[1], IR_RECEIVE_FAILURE_MISSED_PULSE);
+}
+#endif
+
+// Finish decoding the channel's transmission in progress, if any. Returns true if there was one and it's valid
+static bool finishTransmission(receive_channel_t* channel)
+{
+    volatile received_transmission_t* transmission = channel->transmission;
+    if (transmission == 0)
+        return false;
+
+#ifdef TRAINING_PREAMBLE
+    // A transmission that ends part way through its preamble has no data
+    if (!channel->invalid && channel->training_pulse_count != TRAINING_PREAMBLE_LENGTH)
+        failTransmission(channel, IR_RECEIVE_FAILURE_INVALID_PREAMBLE);
+#endif
+#ifdef FRAME_HEADER
+    // Likewise a transmission that ends before its declared length is missing data
+    if (!channel->invalid && !isComplete(channel))
+        failTransmission(channel, IR_RECEIVE_FAILURE_TRUNCATED);
+#elif defined(GAP_MODULATION)
+    // A transmission is never sent without data, so one that ends without any, not counting a zero pulse added to the
+    // end, is missing some
+    if (!channel->invalid && transmission->length <= (channel->padded ? 1 : 0))
+        failTransmission(channel, IR_RECEIVE_FAILURE_TRUNCATED);
+
+    // Drop the zero pulse that was added to the end
+    if (!channel->invalid && channel->padded)
+    {
+        transmission->length--;
+        channel->partial_byte >>= 1;
+#ifdef SOFT_DECISION
+        channel->partial_unreliable >>= 1;
+#endif
+    }
+#endif
+
+    if (channel->invalid)
+        return false;
+
+    // Write out the remaining bits, aligned to the most significant bit
+    uint8_t length = transmission->length;
+    uint8_t partial_bit_count = length & 0b111;
+    if (partial_bit_count != 0)
+    {
+        transmission->data[length >> 3] = (uint8_t)(channel->partial_byte << (8 - partial_bit_count));
+#ifdef SOFT_DECISION
+        transmission->unreliable[length >> 3] = (uint8_t)(channel->partial_unreliable << (8 - partial_bit_count));
+#endif
+    }
+
+    return true;
+}
+
+#ifdef DUAL_SENSOR
+// Copy a finished transmission into the queue, tagged with the sensors that received it. Returns false if there was no
+// room for it, true otherwise
+static bool queueTransmission(received_transmission_t* transmission, uint8_t sensors)
+{
+    volatile received_transmission_t* slot = receivedTransmissionsQueue_reserve(&g_received_transmissions);
+    if (slot == 0)
+    {
+        // The main loop hasn't collected the previous transmissions, so there's nowhere to put this one. Counted as by
+        // failTransmission, though the channel has already finished with it
+        g_failure_counts[IR_RECEIVE_FAILURE_NO_FREE_SLOT]++;
+        g_telemetry.transmissions_discarded++;
+        g_telemetry.queue_overflows++;
+        return false;
+    }
+
+    uint8_t length = transmission->length;
+    uint8_t num_bytes = NUM_BYTES(length);
+    for (uint8_t i = 0; i < num_bytes; i++)
+    {
+        slot->data[i] = transmission->data[i];
+#ifdef SOFT_DECISION
+        slot->unreliable[i] = transmission->unreliable[i];
+#endif
+    }
+    slot->length = length;
+    slot->sensors = sensors;
+
+    receivedTransmissionsQueue_commit(&g_received_transmissions);
+    g_telemetry.transmissions_received++;
+
+    return true;
+}
+
+// Returns true if the two transmissions are the same transmission, as received by both sensors, and merges the second
+// into the first. Returns false and leaves both unchanged otherwise. They're the same if they're the same length and
+// every bit matches, except that with SOFT_DECISION, bits that either sensor flagged as unreliable needn't match. Each
+// merged bit is then taken from whichever sensor received it reliably, and is only unreliable if neither did
+static bool tryMergeTransmissions(received_transmission_t* first, received_transmission_t* second)
+{
+    if (first->length != second->length)
+        return false;
 
-    // We only need to grab the low (L) 8 bits because we've limited the max
-    // timer value
-    uint8_t gap_length = SMT1CPRL;
-    uint8_t pulse_length = SMT1CPWL;
+    uint8_t num_bytes = NUM_BYTES(first->length);
+    for (uint8_t i = 0; i < num_bytes; i++)
+    {
+        uint8_t mismatched = first->data[i] ^ second->data[i];
+#ifdef SOFT_DECISION
+        mismatched &= (uint8_t) ~(first->unreliable[i] | second->unreliable[i]);
+#endif
+        if (mismatched != 0)
+            return false;
+    }
+
+#ifdef SOFT_DECISION
+    for (uint8_t i = 0; i < num_bytes; i++)
+    {
+        uint8_t from_second = first->unreliable[i] & (uint8_t)~second->unreliable[i];
+        first->data[i] = (first->data[i] & (uint8_t)~from_second) | (second->data[i] & from_second);
+        first->unreliable[i] &= second->unreliable[i];
+    }
+#endif
+
+    return true;
+}
+
+// Queue whatever both sensors received, once each has finished decoding. A transmission both received is queued once
+static void queueFinishedTransmissions(void)
+{
+    receive_channel_t* first = &g_channels[0];
+    receive_channel_t* second = &g_channels[1];
+    bool first_received = finishTransmission(first);
+    bool second_received = finishTransmission(second);
+
+    if (first_received && second_received && tryMergeTransmissions(&first->buffer, &second->buffer))
+    {
+        queueTransmission(&first->buffer, IR_RECEIVER_SENSOR_1 | IR_RECEIVER_SENSOR_2);
+        return;
+    }
+
+    // The sensors received something different, most likely the same transmission with different errors. There's no
+    // telling which is right here, so pass them both on, with the second marked as an alternate to the first, and let
+    // the main processor's error checking decide
+    bool first_queued = first_received && queueTransmission(&first->buffer, IR_RECEIVER_SENSOR_1);
+    if (second_received)
+        queueTransmission(&second->buffer, first_queued ? IR_RECEIVER_SENSOR_2 | IR_RECEIVER_ALTERNATE
+                                                        : IR_RECEIVER_SENSOR_2);
+}
+#else
+// Queue the transmission in progress, if it's valid. It was decoded in place, so it only needs committing
+static void queueFinishedTransmissions(void)
+{
+    if (!finishTransmission(&g_channels[0]))
+        return;
+
+    receivedTransmissionsQueue_commit(&g_received_transmissions);
+    g_telemetry.transmissions_received++;
+}
+#endif
+
+#ifdef FRAME_HEADER
+// Queue the channel's transmission now that it has all of its declared length, rather than waiting for the long gap
+// after it, and ignore any more pulses until the long gap
+static void completeTransmission(receive_channel_t* channel)
+{
+    (void)channel;
+
+#ifdef DUAL_SENSOR
+    // If the other sensor is still receiving, it's most likely the same transmission, so wait for it to finish too so
+    // that they can be merged. If it's discarded instead, this one is queued at the long gap
+    for (uint8_t i = 0; i < RECEIVE_CHANNEL_COUNT; i++)
+    {
+        receive_channel_t* other = &g_channels[i];
+        if (other->transmission != 0 && !other->invalid && !isComplete(other))
+            return;
+    }
+#endif
 
-    queue_push(&g_incoming_pulse_widths, gap_length);
-    queue_push(&g_incoming_pulse_widths, pulse_length);
+    queueFinishedTransmissions();
 
-    // Imperfect check for interrupt overlap
-    if (SMT1PWAIF)
+    for (uint8_t i = 0; i < RECEIVE_CHANNEL_COUNT; i++)
     {
-        fatal(ERROR_UNHANDLED_PULSE_MEASUREMENT);
+        if (g_channels[i].transmission != 0)
+        {
+            g_channels[i].transmission = 0;
+            g_channels[i].invalid = true;
+        }
     }
 }
+#endif
 
 static void TMR4InterruptHandler()
 {
@@ -234,9 +1127,13 @@ static void TMR4InterruptHandler()
         return;
 
     TMR4IF = 0;
+    g_telemetry.long_gaps++;
+
+    // A long gap means the end of the transmission in progress, if any
+    queueFinishedTransmissions();
 
-    // Push the reserved value 0xFF onto the queue to indicate "long gap"
-    queue_push(&g_incoming_pulse_widths, 0xFF);
+    for (uint8_t i = 0; i < RECEIVE_CHANNEL_COUNT; i++)
+        resetChannel(&g_channels[i]);
 
     // Turn the timer back on, as the period match that triggered this interrupt
     // also turned off the timer. It will resume counting on the next
@@ -248,93 +1145,108 @@ void irReceiver_interruptHandler()
 {
     TMR4InterruptHandler();
     SMT1InterruptHandler();
+#ifdef DUAL_SENSOR
+    SMT2InterruptHandler();
+#endif
 }
 
-static bool tryDecodePulseLength(uint8_t pulse_length, uint8_t* bit_out)
+bool irReceiver_tryGetTransmission(uint8_t* data_out, uint8_t* data_length_out)
 {
-    // TODO consider loading these macros into constants to avoid evaluating them multiple times
-    if (pulse_length > ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES
-        && pulse_length < ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES)
-    {
-        *bit_out = 0;
-        return true;
-    }
-    else if (pulse_length > ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES
-             && pulse_length < ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES)
-    {
-        *bit_out = 1;
-        return true;
-    }
-    else
-    {
-        // Invalid pulse width
+    // The interrupt handlers have already decoded the transmission, so just copy it out
+    volatile received_transmission_t* transmission = receivedTransmissionsQueue_peek(&g_received_transmissions);
+    if (transmission == 0)
         return false;
-    }
+
+    uint8_t length = transmission->length;
+    uint8_t num_bytes = NUM_BYTES(length);
+    for (uint8_t i = 0; i < num_bytes; i++)
+        data_out[i] = transmission->data[i];
+#ifdef DUAL_SENSOR
+    data_out[num_bytes] = transmission->sensors;
+#endif
+
+    *data_length_out = length;
+
+    receivedTransmissionsQueue_release(&g_received_transmissions);
+    g_telemetry.transmissions_collected++;
+
+    return true;
 }
 
-bool irReceiver_tryGetTransmission(uint8_t* data_out, uint8_t* data_length_out)
+#ifdef SOFT_DECISION
+bool irReceiver_tryGetSoftTransmission(uint8_t* data_out, uint8_t* data_length_out)
 {
-    // data_out must be a static buffer. We're going to use it to accumulate the transmission bits.
-
-    // Length of the current transmission in bits
-    static uint8_t data_length = 0;
-    // A boolean indicating that the transmission currently being analyzed should be discarded
-    static bool invalid_transmission = false;
+    volatile received_transmission_t* transmission = receivedTransmissionsQueue_peek(&g_received_transmissions);
+    if (transmission == 0)
+        return false;
 
-    while (queue_size(&g_incoming_pulse_widths) != 0)
+    uint8_t length = transmission->length;
+    uint8_t num_bytes = NUM_BYTES(length);
+    for (uint8_t i = 0; i < num_bytes; i++)
     {
-        uint8_t gap_length;
-        queue_pop(&g_incoming_pulse_widths, &gap_length);
+        data_out[i] = transmission->data[i];
+        data_out[num_bytes + i] = transmission->unreliable[i];
+    }
+#ifdef DUAL_SENSOR
+    data_out[num_bytes << 1] = transmission->sensors;
+#endif
 
-        // 0xFF is a reserved value meaning "end of transmission"
-        if (gap_length == 0xFF)
-        {
-            if (!invalid_transmission)
-            {
-                *data_length_out = data_length;
-                data_length = 0;
-                return true;
-            }
-            else
-            {
-                // We've reached the end of the invalid transmission, so try the next one
-                invalid_transmission = false;
-                data_length = 0;
-                continue;
-            }
-        }
+    *data_length_out = length;
 
-        // If we're already at max length and about to read another pulse, fail
-        if (data_length > MAX_TRANSMISSION_LENGTH)
-            fatal(ERROR_INCOMING_IR_TRANSMISSION_TOO_LONG);
+    receivedTransmissionsQueue_release(&g_received_transmissions);
+    g_telemetry.transmissions_collected++;
 
-        uint8_t pulse_length;
-        bool empty = !queue_pop(&g_incoming_pulse_widths, &pulse_length);
+    return true;
+}
+#endif
 
-        // There must be another element in the queue, because gap and pulse lengths are added in pairs except for the
-        // terminating gap, which we checked for above
-        if (empty)
-            fatal(ERROR_INCOMING_PULSE_LENGTHS_QUEUE_EMPTY);
+void irReceiver_dropOldestTransmission()
+{
+    if (receivedTransmissionsQueue_size(&g_received_transmissions)
+        != receivedTransmissionsQueue_capacity(&g_received_transmissions))
+        return;
 
-        // Don't bother analyzing the pulse length if the transmission is invalid
-        if (invalid_transmission)
-            continue;
+    receivedTransmissionsQueue_release(&g_received_transmissions);
+    g_failure_counts[IR_RECEIVE_FAILURE_DROPPED]++;
+}
 
-        uint8_t bit;
-        bool is_valid_pulse_length = tryDecodePulseLength(pulse_length, &bit);
-        if (is_valid_pulse_length)
-        {
-            bitArray_setBit(data_out, data_length, bit);
-            data_length++;
-        }
-        else
-        {
-            // Invalid pulse width. Something has gone wrong, so we're going to ignore this transmission
-            invalid_transmission = true;
-        }
-    }
+uint8_t irReceiver_getFailureCount(ir_receive_failure_t cause)
+{
+    return g_failure_counts[cause];
+}
+
+// Keep the interrupt handlers from updating a count part way through reading it. A pulse or gap that ends in the
+// meantime is handled as soon as they're unmasked
+static void maskInterrupts(void)
+{
+    SMT1PWAIE = 0;
+#ifdef DUAL_SENSOR
+    SMT2PWAIE = 0;
+#endif
+    TMR4IE = 0;
+}
+
+static void unmaskInterrupts(void)
+{
+    SMT1PWAIE = 1;
+#ifdef DUAL_SENSOR
+    SMT2PWAIE = 1;
+#endif
+    TMR4IE = 1;
+}
+
+void irReceiver_getTelemetry(ir_receiver_telemetry_t* telemetry_out)
+{
+    maskInterrupts();
+    *telemetry_out = g_telemetry;
+    unmaskInterrupts();
+}
 
-    return false;
+void irReceiver_resetTelemetry()
+{
+    maskInterrupts();
+    g_telemetry = (ir_receiver_telemetry_t){0};
+    unmaskInterrupts();
 }
 
 void receiverStaticAsserts(void)
@@ -342,17 +1254,53 @@ void receiverStaticAsserts(void)
     // Pulse lengths in terms of SMT1 cycles must fit in 8 bits with room to spare
     if ((ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES) > 200)
         fatal(ERROR_PULSE_MEASUREMENT_DOESNT_FIT_SMT1);
+#ifdef MULTI_LEVEL_SYMBOLS
+    if ((TWO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES) > 200)
+        fatal(ERROR_PULSE_MEASUREMENT_DOESNT_FIT_SMT1);
+#endif
+
+    // A longer pulse makes the receiver wait out a long gap after it
+    if ((LONGEST_PULSE_LENGTH_MOD_CYCLES) > (RECEIVER_PULSE_MAX_CYCLES))
+        fatal(ERROR_PULSE_LONGER_THAN_RECEIVER_ALLOWS);
 
     // The transmission gap length, in terms of SMT1 cycles, must fit in 8 bits
     if ((MIN_TRANSMISSION_GAP_LENGTH_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO) > 255)
         fatal(ERROR_GAP_MEASUREMENT_DOESNT_FIT_SMT1);
 
+#ifdef FRAME_HEADER
+    // The delimiter is matched within one byte, and the length field must be able to hold any transmission length
+    if ((START_OF_FRAME_DELIMITER_LENGTH) > 8 || (FRAME_LENGTH_FIELD_LENGTH) > 8
+        || (1 << (FRAME_LENGTH_FIELD_LENGTH)) <= (MAX_TRANSMISSION_LENGTH))
+        fatal(ERROR_INVALID_FRAME_HEADER_LENGTH);
+#endif
+
+#ifdef TRAINING_PREAMBLE
+    // The preamble is averaged a pair of pulses at a time
+    if (TRAINING_PREAMBLE_LENGTH != 4)
+        fatal(ERROR_INVALID_TRAINING_PREAMBLE_LENGTH);
+#else
     // The 0/1 pulse length ranges must not overlap
     if (((ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES) > (ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES)
          && (ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES) < (ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES))
         || ((ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES) > (ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES)
             && (ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES) < (ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES)))
         fatal(ERROR_OVERLAPPING_PULSE_LENGTH_RANGES);
+#endif
+
+    // The receiver's bias must not be able to close a pulse gap completely, or there's no telling a short gap from an
+    // overlapping transmission
+    if ((PULSE_GAP_LENGTH_MOD_CYCLES)*10 <= (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10))
+        fatal(ERROR_PULSE_GAP_SHORTER_THAN_RECEIVER_BIAS);
+
+    // A gap that's too long to be a pulse gap must still be too short to end the transmission, or invalid gaps can't
+    // be detected
+    if ((LONGEST_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES) >= (MIN_TRANSMISSION_GAP_LENGTH_SMT1_CYCLES))
+        fatal(ERROR_PULSE_GAP_RANGE_OVERLAPS_TRANSMISSION_GAP);
+
+#if defined(GAP_MODULATION) && defined(MULTI_LEVEL_SYMBOLS)
+    // A symbol's two pulses are decoded together, so there's nowhere for the bit in the gap between them
+    fatal(ERROR_INCOMPATIBLE_MODULATION_OPTIONS);
+#endif
 
     // The transmission gap length, in terms of TMR4 cycles, must fit in T4PR
     if (MIN_TRANSMISSION_GAP_LENGTH_TMR4_CYCLES > 255)
@@ -373,4 +1321,13 @@ const volatile uint16_t ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES_eval = ZERO_PU
 const volatile uint16_t ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES_eval = ZERO_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES;
 const volatile uint16_t ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES_eval = ONE_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES;
 const volatile uint16_t ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES_eval = ONE_PULSE_LENGTH_LOWER_BOUND_SMT1_CYCLES;
+#ifdef MULTI_LEVEL_SYMBOLS
+const volatile uint16_t TWO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES_eval = TWO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES;
+#endif
+const volatile uint16_t PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES_eval = PULSE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES;
+const volatile uint16_t PULSE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES_eval = PULSE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES;
+#ifdef GAP_MODULATION
+const volatile uint16_t ONE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES_eval = ONE_GAP_LENGTH_UPPER_BOUND_SMT1_CYCLES;
+const volatile uint16_t ONE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES_eval = ONE_GAP_LENGTH_LOWER_BOUND_SMT1_CYCLES;
+#endif
 #endif
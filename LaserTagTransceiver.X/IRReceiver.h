@@ -1,18 +1,51 @@
 #ifndef IRRECEIVER_H
 #define IRRECEIVER_H
 
+#include "transmissionConstants.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef DUAL_SENSOR
+// Flags for the sensors that received a transmission. See irLinkProtocol.h
+#define IR_RECEIVER_SENSOR_1 (SENSOR_1_FLAG)
+#define IR_RECEIVER_SENSOR_2 (SENSOR_2_FLAG)
+#define IR_RECEIVER_ALTERNATE (ALTERNATE_TRANSMISSION_FLAG)
+#endif
+
 void irReceiver_initialize(void);
 void irReceiver_shutdown(void);
 
 void irReceiver_interruptHandler(void);
 
 // Returns true and copies the transmission data and length, in bits, into the out parameters if a transmission was
-// received since the last call to tryGetTransmissionData. Returns false otherwise. data_out must point to a static
-// buffer of at least ((MAX_TRANSMISSION_LENGTH + 7) / 8 bytes. The contents of data_out are
-// undefined when this function returns false.
+// received since the last call to tryGetTransmissionData. Returns false otherwise. data_out must point to a buffer of
+// at least NUM_BYTES(MAX_TRANSMISSION_LENGTH) bytes. Transmissions are decoded as they are received, by the interrupt
+// handler, so this only copies one out. The contents of data_out are undefined when this function returns false. With
+// DUAL_SENSOR, the data is followed immediately by a byte of IR_RECEIVER_SENSOR_ flags for the sensors that received
+// the transmission, so data_out must have room for one more byte
 bool irReceiver_tryGetTransmission(uint8_t* data_out, uint8_t* data_length_out);
 
+#ifdef SOFT_DECISION
+// As irReceiver_tryGetTransmission, except the data is followed immediately by a reliability flag for each bit, in the
+// same layout as the data, so NUM_BYTES of the length in bytes of each. A set flag means the pulse for that bit was
+// close to, or just outside, the edge of the window for a zero or a one. data_out must point to a buffer of at least
+// RECEIVED_TRANSMISSION_BYTES(MAX_TRANSMISSION_LENGTH) bytes. With DUAL_SENSOR, the flags are followed by the sensor
+// flags
+bool irReceiver_tryGetSoftTransmission(uint8_t* data_out, uint8_t* data_length_out);
+#endif
+
+// Returns the number of transmissions discarded for the given cause, modulo 256. The count is never reset, so the
+// number of failures since an earlier call is the difference between the two counts
+uint8_t irReceiver_getFailureCount(ir_receive_failure_t cause);
+
+// If every received transmission slot is full, discard the oldest transmission to make room for the next, counting it
+// as IR_RECEIVE_FAILURE_DROPPED. Call when there's nowhere to put a transmission and the IR_RECEIVE_FAILURE_NO_FREE_SLOT
+// count has moved, to drop old transmissions rather than new ones
+void irReceiver_dropOldestTransmission(void);
+
+// Copy out or clear the telemetry counters. Both briefly mask the receiver's interrupts, which write most of them
+void irReceiver_getTelemetry(ir_receiver_telemetry_t* telemetry_out);
+void irReceiver_resetTelemetry(void);
+
 #endif /* IRRECEIVER_H */
@@ -18,6 +18,8 @@
 #define RECEIVER_MODULATION_FREQ 56000  // 56kHz
 #define RECEIVER_PULSE_MIN_CYCLES 6
 #define RECEIVER_GAP_MIN_CYCLES 10
+// The longest pulse that can be sent without the long gap after it. See above
+#define RECEIVER_PULSE_MAX_CYCLES 23
 
 // If the receiver receives an optical signal pulse consisting of x modulation
 // cycles, it will output an electrical signal up to
@@ -27,13 +29,17 @@
 // To increase resolution, these values are both 10x the real value.
 // We have decided to widen the range of valid pulse lengths to beyond spec.
 // This allows us to handle lower irradiances, which is important for range, but
-// also increases the length of all transmissions. In both constants below, the
-// first value is according to spec, and the second value is our adjustment.
+// also increases the length of all transmissions. The spec values are below,
+// followed by the constants with our adjustments.
 // These should be adjusted empirically based on testing in various
 // environments. Longer transmission may affect range when aiming a tagger with
 // shaky hands, for example.
-#define RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10 (35 + 40)
-#define RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10 (30 + 0)
+#define RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_SPEC_MOD_CYCLES_x10 35
+#define RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_SPEC_MOD_CYCLES_x10 30
+#define RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10 \
+    ((RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_SPEC_MOD_CYCLES_x10) + 40)
+#define RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10 \
+    ((RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_SPEC_MOD_CYCLES_x10) + 0)
 
 #define EVALUATE_CONSTANTS
 #ifdef EVALUATE_CONSTANTS
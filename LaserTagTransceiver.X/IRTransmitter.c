@@ -1,7 +1,7 @@
 #include "IRTransmitter.h"
 
 #include "../LaserTagUtils.X/bitArray.h"
-#include "../LaserTagUtils.X/queue.h"
+#include "../LaserTagUtils.X/spscQueue.h"
 #include "clc.h"
 #include "error.h"
 #include "pins.h"
@@ -210,8 +210,14 @@ static void configureCLC1(void)
 
 // Pulse lengths in terms of TMR2 cycles
 #define PULSE_GAP_LENGTH_TMR2_CYCLES ((PULSE_GAP_LENGTH_MOD_CYCLES) * (TMR2_MOD_CLOCK_RATIO))
+#ifdef GAP_MODULATION
+#define ONE_GAP_LENGTH_TMR2_CYCLES ((ONE_GAP_LENGTH_MOD_CYCLES) * (TMR2_MOD_CLOCK_RATIO))
+#endif
 #define ZERO_PULSE_LENGTH_TMR2_CYCLES ((ZERO_PULSE_LENGTH_MOD_CYCLES) * (TMR2_MOD_CLOCK_RATIO))
 #define ONE_PULSE_LENGTH_TMR2_CYCLES ((ONE_PULSE_LENGTH_MOD_CYCLES) * (TMR2_MOD_CLOCK_RATIO))
+#ifdef MULTI_LEVEL_SYMBOLS
+#define TWO_PULSE_LENGTH_TMR2_CYCLES ((TWO_PULSE_LENGTH_MOD_CYCLES) * (TMR2_MOD_CLOCK_RATIO))
+#endif
 
 // Number of TMR2 cycles in a single period of the PWM carrier signal
 #define MOD_PERIOD_TMR2_CYCLES (TMR2_MOD_CLOCK_RATIO)
@@ -219,11 +225,151 @@ static void configureCLC1(void)
 
 typedef uint8_t TMR2_t;
 
-// Double the maximum transmission length in bits
-#define OUTGOING_PULSE_WIDTHS_STORAGE_SIZE ((MAX_TRANSMISSION_LENGTH) << 1)
-static uint8_t g_outgoing_pulse_widths_storage[OUTGOING_PULSE_WIDTHS_STORAGE_SIZE];
+// Double the maximum transmission length in bits, plus the training preamble if any, rounded up to a power of two so
+// that the queue can wrap its indices with a mask. This queue is popped from the TMR2 interrupt handler, so the cheaper
+// pop is worth the extra bytes. irTransmitter_transmitAsync is the producer and the TMR2 interrupt handler is the
+// consumer
+#define OUTGOING_PULSE_WIDTHS_STORAGE_SIZE 256
 // Active and inactive pulse widths
-static queue_t g_outgoing_pulse_widths;
+static SPSC_QUEUE_T(OUTGOING_PULSE_WIDTHS_STORAGE_SIZE) g_outgoing_pulse_widths;
+
+#ifdef FRAME_HEADER
+#ifdef TRAINING_PREAMBLE
+#define PREAMBLE_LENGTH (TRAINING_PREAMBLE_LENGTH)
+#else
+#define PREAMBLE_LENGTH 0
+#endif
+// The longest transmission that fits in the pulse widths queue along with its preamble and header. Each pulse takes a
+// pulse width and a gap width, and the queue holds one fewer width than its storage size. Each bit takes a pulse, or
+// with MULTI_LEVEL_SYMBOLS, each symbol takes two. With GAP_MODULATION, each bit takes a single width, plus one for a
+// zero pulse added to the end and one for the gap after the last pulse
+#if defined(GAP_MODULATION)
+#define MAX_FRAMED_TRANSMISSION_LENGTH \
+    (((OUTGOING_PULSE_WIDTHS_STORAGE_SIZE)-1) - ((PREAMBLE_LENGTH) << 1) - 2 - (FRAME_HEADER_LENGTH))
+#elif defined(MULTI_LEVEL_SYMBOLS)
+#define MAX_FRAMED_TRANSMISSION_LENGTH                                                          \
+    (((((OUTGOING_PULSE_WIDTHS_STORAGE_SIZE)-1) / 2 - (PREAMBLE_LENGTH)) / 2) * (SYMBOL_LENGTH) \
+     - (FRAME_HEADER_LENGTH))
+#else
+#define MAX_FRAMED_TRANSMISSION_LENGTH \
+    (((OUTGOING_PULSE_WIDTHS_STORAGE_SIZE)-1) / 2 - (PREAMBLE_LENGTH) - (FRAME_HEADER_LENGTH))
+#endif
+#endif
+
+#ifdef MULTI_LEVEL_SYMBOLS
+// The levels of the two pulses for each symbol, the first in the high nibble and the second in the low nibble. See
+// SYMBOL_LENGTH
+static const uint8_t g_symbol_levels[8] = {0x00, 0x01, 0x10, 0x02, 0x21, 0x22, 0x20, 0x12};
+// The width of a pulse of each level
+static const TMR2_t g_level_widths[3] = {ZERO_PULSE_LENGTH_TMR2_CYCLES, ONE_PULSE_LENGTH_TMR2_CYCLES,
+                                         TWO_PULSE_LENGTH_TMR2_CYCLES};
+#endif
+
+// The state of turning an outgoing transmission's bits into pulse widths
+typedef struct
+{
+    // True once the first pulse has been queued. Every later pulse is preceded by a pulse gap
+    bool started;
+#ifdef GAP_MODULATION
+    // True if the last pulse queued was a bit, so the next bit is sent as the gap after it
+    bool next_bit_in_gap;
+    // True if the gap before the next pulse has already been queued, as a bit
+    bool gap_queued;
+#endif
+#ifdef MULTI_LEVEL_SYMBOLS
+    // The bits of the symbol in progress, in the least significant bits, and how many of them there are so far
+    uint8_t symbol;
+    uint8_t symbol_bit_count;
+#endif
+} pulse_encoder_t;
+
+// Queue a pulse of the given width, after a pulse gap unless it's the first pulse of the transmission or, with
+// GAP_MODULATION, the gap before it has been queued already
+static void pushPulse(pulse_encoder_t* encoder, TMR2_t pulse_width)
+{
+#ifdef GAP_MODULATION
+    if (encoder->started && !encoder->gap_queued)
+        spscQueue_push(&g_outgoing_pulse_widths, PULSE_GAP_LENGTH_TMR2_CYCLES - 1);
+    encoder->gap_queued = false;
+#else
+    if (encoder->started)
+        spscQueue_push(&g_outgoing_pulse_widths, PULSE_GAP_LENGTH_TMR2_CYCLES - 1);
+#endif
+
+    spscQueue_push(&g_outgoing_pulse_widths, pulse_width);
+    encoder->started = true;
+}
+
+// Queue one bit as a pulse of its own, or with MULTI_LEVEL_SYMBOLS, as part of a symbol, which is queued as a pair of
+// pulses once it has all of its bits. With GAP_MODULATION, every other bit is queued as the gap after the pulse before
+// it instead
+static void pushBit(pulse_encoder_t* encoder, uint8_t bit)
+{
+#ifdef GAP_MODULATION
+    if (encoder->next_bit_in_gap)
+    {
+        spscQueue_push(&g_outgoing_pulse_widths,
+                       bit != 0 ? ONE_GAP_LENGTH_TMR2_CYCLES - 1 : PULSE_GAP_LENGTH_TMR2_CYCLES - 1);
+        encoder->next_bit_in_gap = false;
+        encoder->gap_queued = true;
+        return;
+    }
+
+    encoder->next_bit_in_gap = true;
+#endif
+
+#ifdef MULTI_LEVEL_SYMBOLS
+    uint8_t symbol = (uint8_t)(encoder->symbol << 1) | bit;
+    encoder->symbol_bit_count++;
+
+    if (encoder->symbol_bit_count != SYMBOL_LENGTH)
+    {
+        encoder->symbol = symbol;
+        return;
+    }
+
+    uint8_t levels = g_symbol_levels[symbol];
+    pushPulse(encoder, g_level_widths[levels >> 4]);
+    pushPulse(encoder, g_level_widths[levels & 0x0F]);
+
+    encoder->symbol = 0;
+    encoder->symbol_bit_count = 0;
+#else
+    pushPulse(encoder, bit != 0 ? ONE_PULSE_LENGTH_TMR2_CYCLES : ZERO_PULSE_LENGTH_TMR2_CYCLES);
+#endif
+}
+
+// Queue the given number of bits, up to eight, taken from the most significant bit of the given byte down. Shifting
+// each bit in turn into the most significant bit is cheaper than looking it up by its index
+static void pushBits(pulse_encoder_t* encoder, uint8_t bits, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        pushBit(encoder, (bits & 0x80) != 0 ? 1 : 0);
+        bits <<= 1;
+    }
+}
+
+// Queue whatever is left of the transmission after its last bit
+static void finishPulses(pulse_encoder_t* encoder)
+{
+#ifdef MULTI_LEVEL_SYMBOLS
+    // Pad the last symbol out with zeros. The receiver stops at the transmission's declared length, so ignores them
+    while (encoder->symbol_bit_count != 0)
+        pushBit(encoder, 0);
+#endif
+#ifdef GAP_MODULATION
+    // The last bit was a gap, which needs a pulse to end it
+    if (encoder->gap_queued)
+        pushPulse(encoder, ZERO_PULSE_LENGTH_TMR2_CYCLES);
+#endif
+
+    // Push a large gap width after the final active pulse. During this gap we will detect that the transmission is
+    // finished and disable the output modules, so we're making it large so that the an errant pulse doesn't start
+    // before we get around to disabling the modules
+    if (encoder->started)
+        spscQueue_push(&g_outgoing_pulse_widths, 0xFF);
+}
 
 static void disableTransmissionModules(void)
 {
@@ -255,7 +401,7 @@ static void endTransmission(void)
 static void setNextPeriod(void)
 {
     uint8_t pulse_width;
-    bool empty = !queue_pop(&g_outgoing_pulse_widths, &pulse_width);
+    bool empty = !spscQueue_pop(&g_outgoing_pulse_widths, &pulse_width);
     if (empty)
         endTransmission();
     else
@@ -307,7 +453,14 @@ void irTransmitter_initialize()
     configureCLC2();
     configureCLC1();
 
-    g_outgoing_pulse_widths = queue_create(g_outgoing_pulse_widths_storage, OUTGOING_PULSE_WIDTHS_STORAGE_SIZE);
+    spscQueue_initialize(&g_outgoing_pulse_widths);
+
+#ifdef FRAME_HEADER
+    // The header's pulses have to fit in the queue along with the longest transmission. Constant, so compiled out when
+    // they fit
+    if ((MAX_TRANSMISSION_LENGTH) > (MAX_FRAMED_TRANSMISSION_LENGTH))
+        fatal(ERROR_OUTGOING_IR_TRANSMISSION_TOO_LONG);
+#endif
 }
 
 void irTransmitter_shutdown()
@@ -324,7 +477,7 @@ void irTransmitter_interruptHandler()
     TMR2IF = 0;
 
     uint8_t pulse_width;
-    bool empty = !queue_pop(&g_outgoing_pulse_widths, &pulse_width);
+    bool empty = !spscQueue_pop(&g_outgoing_pulse_widths, &pulse_width);
     if (empty)
         endTransmission();
     else
@@ -339,30 +492,51 @@ void irTransmitter_interruptHandler()
 
 bool irTransmitter_transmitAsync(uint8_t* data, uint8_t length)
 {
-    if (queue_size(&g_outgoing_pulse_widths) != 0)
+    circular_buffer_span_t span = {
+        .first = data, .first_length = NUM_BYTES(length), .second = data, .second_length = 0,
+    };
+
+    return irTransmitter_transmitSpanAsync(&span, length);
+}
+
+bool irTransmitter_transmitSpanAsync(circular_buffer_span_t* data, uint8_t length)
+{
+    if (spscQueue_size(&g_outgoing_pulse_widths) != 0)
         return false;
 
-    for (uint8_t i = 0; i < length; i++)
+    pulse_encoder_t encoder = {0};
+
+#ifdef TRAINING_PREAMBLE
+    // Alternating zero and one pulses, from which the receiver measures the widths of this transmission's pulses. They
+    // aren't bits, so aren't part of any symbol
+    for (uint8_t i = 0; i < TRAINING_PREAMBLE_LENGTH; i++)
+        pushPulse(&encoder, (i & 1) == 0 ? ZERO_PULSE_LENGTH_TMR2_CYCLES : ONE_PULSE_LENGTH_TMR2_CYCLES);
+#endif
+
+#ifdef FRAME_HEADER
+    // The start-of-frame delimiter, then the length in bits
+    pushBits(&encoder, (uint8_t)((START_OF_FRAME_DELIMITER) << (8 - (START_OF_FRAME_DELIMITER_LENGTH))),
+             START_OF_FRAME_DELIMITER_LENGTH);
+    pushBits(&encoder, (uint8_t)(length << (8 - (FRAME_LENGTH_FIELD_LENGTH))), FRAME_LENGTH_FIELD_LENGTH);
+#elif defined(GAP_MODULATION)
+    // Whether a zero pulse will be added to the end, which is when this bit and the data come to an even number of bits
+    pushBit(&encoder, length & 1);
+#endif
+
+    // Byte order: little endian, e.g. byte at index 0 is output first
+    // Bit order: big endian, e.g. bit at index 0 is output last
+    uint8_t byte_index = 0;
+    uint8_t remaining = length;
+    while (remaining != 0)
     {
-        // Byte order: little endian, e.g. byte at index 0 is output first
-        // Bit order: big endian, e.g. bit at index 0 is output last
-        TMR2_t pulse_width = bitArray_getBit(data, i) ? ONE_PULSE_LENGTH_TMR2_CYCLES : ZERO_PULSE_LENGTH_TMR2_CYCLES;
-
-        queue_push(&g_outgoing_pulse_widths, pulse_width);
-
-        if (i == length - 1)
-        {
-            // Push a large gap width after the final active pulse. During this gap we will detect that the transmission
-            // is finished and disable the output modules, so we're making it large so that the an errant pulse doesn't
-            // start before we get around to disabling the modules
-            queue_push(&g_outgoing_pulse_widths, 0xFF);
-        }
-        else
-        {
-            queue_push(&g_outgoing_pulse_widths, PULSE_GAP_LENGTH_TMR2_CYCLES - 1);
-        }
+        uint8_t count = remaining < 8 ? remaining : 8;
+        pushBits(&encoder, circularBuffer_spanGet(data, byte_index), count);
+        byte_index++;
+        remaining -= count;
     }
 
+    finishPulses(&encoder);
+
     // This starts the asynchronous dominoes that send the transmission
     enableTransmissionModules();
 
@@ -377,5 +551,11 @@ const volatile uint16_t TMR2_MOD_CLOCK_RATIO_eval = TMR2_MOD_CLOCK_RATIO;
 const volatile uint16_t PULSE_GAP_LENGTH_TMR2_CYCLES_eval = PULSE_GAP_LENGTH_TMR2_CYCLES;
 const volatile uint16_t ZERO_PULSE_LENGTH_TMR2_CYCLES_eval = ZERO_PULSE_LENGTH_TMR2_CYCLES;
 const volatile uint16_t ONE_PULSE_LENGTH_TMR2_CYCLES_eval = ONE_PULSE_LENGTH_TMR2_CYCLES;
+#ifdef GAP_MODULATION
+const volatile uint16_t ONE_GAP_LENGTH_TMR2_CYCLES_eval = ONE_GAP_LENGTH_TMR2_CYCLES;
+#endif
+#ifdef MULTI_LEVEL_SYMBOLS
+const volatile uint16_t TWO_PULSE_LENGTH_TMR2_CYCLES_eval = TWO_PULSE_LENGTH_TMR2_CYCLES;
+#endif
 const volatile uint16_t MOD_PERIOD_TMR2_CYCLES_eval = MOD_PERIOD_TMR2_CYCLES;
 #endif
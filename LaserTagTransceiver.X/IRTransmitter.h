@@ -1,6 +1,8 @@
 #ifndef IRTRANSMITTER_H
 #define IRTRANSMITTER_H
 
+#include "../LaserTagUtils.X/circularBuffer.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -14,5 +16,8 @@ void irTransmitter_interruptHandler(void);
 // in big endian order, e.g. the 0th bit is transmitted last, e.g. the 0th bit of the 0th is the last to be sent. If a
 // transmission is in progress, returns false and does nothing. Otherwise returns true
 bool irTransmitter_transmitAsync(uint8_t* data, uint8_t length);
+// As irTransmitter_transmitAsync, but reads the transmission data from a span, e.g. in place in a queue. The data is
+// encoded before returning, so the span can be released as soon as this returns
+bool irTransmitter_transmitSpanAsync(circular_buffer_span_t* data, uint8_t length);
 
 #endif /* IRTRANSMITTER_H */
@@ -20,7 +20,17 @@ enum
     ERROR_OVERLAPPING_PULSE_LENGTH_RANGES,
     ERROR_TRANSMISSION_GAP_LENGTH_DOESNT_FIT_TMR4,
     ERROR_NO_TRANSMISSION_TO_SEND,
-    ERROR_INCOMING_PULSE_LENGTHS_QUEUE_EMPTY
+    ERROR_INCOMING_PULSE_LENGTHS_QUEUE_EMPTY,
+    ERROR_INCOMING_PULSE_LENGTHS_QUEUE_TOO_SMALL,
+    ERROR_INVALID_TRAINING_PREAMBLE_LENGTH,
+    ERROR_PULSE_GAP_SHORTER_THAN_RECEIVER_BIAS,
+    ERROR_PULSE_GAP_RANGE_OVERLAPS_TRANSMISSION_GAP,
+    ERROR_UNKNOWN_I2C_COMMAND,
+    ERROR_INVALID_FRAME_HEADER_LENGTH,
+    ERROR_PULSE_LONGER_THAN_RECEIVER_ALLOWS,
+    ERROR_INCOMPATIBLE_MODULATION_OPTIONS,
+    ERROR_OUTGOING_FRAME_POOL_TOO_SMALL,
+    ERROR_OUTGOING_IR_TRANSMISSION_TOO_SHORT
     // clang-format on
 };
 
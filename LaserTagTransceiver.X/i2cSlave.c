@@ -1,24 +1,41 @@
 #include "i2cSlave.h"
 
+#include "../LaserTagUtils.X/bitArray.h"
+#include "../LaserTagUtils.X/framePool.h"
+#include "../LaserTagUtils.X/framedStringQueue.h"
 #include "../LaserTagUtils.X/queue.h"
-#include "../LaserTagUtils.X/stringQueue.h"
 #include "error.h"
 #include "pins.h"
+#include "transmissionConstants.h"
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>  // for memcpy
 
 #include <xc.h>
 
 #define INCOMING_MESSAGE_QUEUE_LENGTH 128
 
 uint8_t g_incoming_message_queue_storage[INCOMING_MESSAGE_QUEUE_LENGTH];
-string_queue_t g_incoming_message_queue;
+framed_string_queue_t g_incoming_message_queue;
 
-#define OUTGOING_MESSAGE_QUEUE_LENGTH 128
+// Outgoing data is written in whole frames. Each frame is big enough for a received IR transmission and its length
+#define OUTGOING_FRAME_COUNT 8
 
-uint8_t g_outgoing_message_queue_storage[OUTGOING_MESSAGE_QUEUE_LENGTH];
-queue_t g_outgoing_message_queue;
+uint8_t g_outgoing_frame_pool_storage[FRAME_POOL_STORAGE_LENGTH(I2C_SLAVE_FRAME_SIZE, OUTGOING_FRAME_COUNT)];
+frame_pool_t g_outgoing_frame_pool;
+
+// Handles and lengths of the frames waiting to be sent, in pairs. One more than the number of frames, because a queue
+// stores one fewer byte than its length
+#define OUTGOING_FRAME_QUEUE_LENGTH ((OUTGOING_FRAME_COUNT << 1) + 1)
+
+uint8_t g_outgoing_frame_queue_storage[OUTGOING_FRAME_QUEUE_LENGTH];
+queue_t g_outgoing_frame_queue;
+
+// The frame currently being sent, and how far through it we are
+frame_handle_t g_sending_frame = FRAME_POOL_NO_FRAME;
+uint8_t g_sending_frame_index = 0;
+uint8_t g_sending_frame_length = 0;
 
 void i2cSlave_initialize()
 {
@@ -43,8 +60,14 @@ void i2cSlave_initialize()
     // address goes in bits 1-7 of the register
     SSP1ADD = 0b1010001 << 1;
 
-    g_outgoing_message_queue = queue_create(g_outgoing_message_queue_storage, OUTGOING_MESSAGE_QUEUE_LENGTH);
-    g_incoming_message_queue = stringQueue_create(g_incoming_message_queue_storage, INCOMING_MESSAGE_QUEUE_LENGTH);
+    g_outgoing_frame_pool = framePool_create(g_outgoing_frame_pool_storage, sizeof(g_outgoing_frame_pool_storage),
+                                             I2C_SLAVE_FRAME_SIZE);
+    // The storage is sized for the frames, but a pool holds no more than FRAME_POOL_MAX_FRAME_COUNT
+    if (framePool_frameCount(&g_outgoing_frame_pool) != OUTGOING_FRAME_COUNT)
+        fatal(ERROR_OUTGOING_FRAME_POOL_TOO_SMALL);
+    g_outgoing_frame_queue = queue_create(g_outgoing_frame_queue_storage, OUTGOING_FRAME_QUEUE_LENGTH);
+    g_incoming_message_queue
+        = framedStringQueue_create(g_incoming_message_queue_storage, INCOMING_MESSAGE_QUEUE_LENGTH);
 }
 
 void i2cSlave_shutdown()
@@ -54,44 +77,105 @@ void i2cSlave_shutdown()
 
 bool i2cSlave_read(uint8_t max_data_length, uint8_t* data_out, uint8_t* data_length_out)
 {
-    if (stringQueue_hasFullString(&g_incoming_message_queue))
+    if (framedStringQueue_hasFullString(&g_incoming_message_queue))
     {
-        return stringQueue_pop(&g_incoming_message_queue, max_data_length, data_out, data_length_out);
+        return framedStringQueue_pop(&g_incoming_message_queue, max_data_length, data_out, data_length_out);
     }
 
     *data_length_out = 0;
     return false;
 }
 
+uint8_t i2cSlave_peek(circular_buffer_span_t* message_out)
+{
+    return framedStringQueue_peek(&g_incoming_message_queue, message_out);
+}
+
+void i2cSlave_release()
+{
+    framedStringQueue_release(&g_incoming_message_queue);
+}
+
 void i2cSlave_write(uint8_t* data, uint8_t data_length)
 {
-    for (uint8_t i = 0; i < data_length; i++)
-    {
-        if (!queue_push(&g_outgoing_message_queue, data[i]))
-            fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
-    }
+    if (data_length > I2C_SLAVE_FRAME_SIZE)
+        fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
+
+    frame_handle_t frame = i2cSlave_allocateFrame();
+    memcpy(i2cSlave_getFrame(frame), data, data_length);
+    i2cSlave_writeFrame(frame, data_length);
+}
+
+frame_handle_t i2cSlave_allocateFrame()
+{
+    frame_handle_t frame = i2cSlave_tryAllocateFrame();
+    if (frame == FRAME_POOL_NO_FRAME)
+        fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
+
+    return frame;
+}
+
+frame_handle_t i2cSlave_tryAllocateFrame()
+{
+    return framePool_allocate(&g_outgoing_frame_pool);
+}
+
+uint8_t* i2cSlave_getFrame(frame_handle_t frame)
+{
+    return framePool_getFrame(&g_outgoing_frame_pool, frame);
+}
+
+void i2cSlave_writeFrame(frame_handle_t frame, uint8_t length)
+{
+    // There is always room in the queue, as it has room for every frame in the pool
+    uint8_t entry[2] = {frame, length};
+    queue_pushSpan(&g_outgoing_frame_queue, entry, 2);
 }
 
 static uint8_t getNextByteToWrite()
 {
-    uint8_t byte;
-    if (!queue_pop(&g_outgoing_message_queue, &byte))
-        // If the master asks for data and we have none, return zero
-        byte = 0;
+    // Start on the next frame if there is no frame being sent. Loop in case a frame is empty
+    while (g_sending_frame == FRAME_POOL_NO_FRAME || g_sending_frame_length == 0)
+    {
+        if (g_sending_frame != FRAME_POOL_NO_FRAME)
+            framePool_free(&g_outgoing_frame_pool, g_sending_frame);
+
+        uint8_t entry[2];
+        if (queue_popSpan(&g_outgoing_frame_queue, 2, entry) == 0)
+        {
+            // If the master asks for data and we have none, return zero
+            g_sending_frame = FRAME_POOL_NO_FRAME;
+            return 0;
+        }
+
+        g_sending_frame = entry[0];
+        g_sending_frame_length = entry[1];
+        g_sending_frame_index = 0;
+    }
+
+    uint8_t byte = i2cSlave_getFrame(g_sending_frame)[g_sending_frame_index];
+    g_sending_frame_index++;
+
+    // Free the frame as soon as its last byte is sent, rather than holding it until the master reads again
+    if (g_sending_frame_index == g_sending_frame_length)
+    {
+        framePool_free(&g_outgoing_frame_pool, g_sending_frame);
+        g_sending_frame = FRAME_POOL_NO_FRAME;
+    }
 
     return byte;
 }
 
 static void setReceivedByte(uint8_t data)
 {
-    if (!stringQueue_pushPartial(&g_incoming_message_queue, &data, 1, false))
+    if (!framedStringQueue_pushPartial(&g_incoming_message_queue, &data, 1, false))
         fatal(ERROR_I2C_INCOMING_QUEUE_FULL);
 }
 
 static void endRead()
 {
     // Mark the last byte added as the end of the string
-    stringQueue_pushPartial(&g_incoming_message_queue, 0, 0, true);
+    framedStringQueue_pushPartial(&g_incoming_message_queue, 0, 0, true);
 }
 
 void i2cSlave_eventHandler(void)
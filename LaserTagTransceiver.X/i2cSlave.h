@@ -1,9 +1,17 @@
 #ifndef I2CMASTER_H
 #define I2CMASTER_H
 
+#include "../LaserTagUtils.X/bitArray.h"
+#include "../LaserTagUtils.X/circularBuffer.h"
+#include "../LaserTagUtils.X/framePool.h"
+#include "transmissionConstants.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
+// The size of the frames that outgoing data is written in. Big enough for a received IR transmission and its length
+#define I2C_SLAVE_FRAME_SIZE (RECEIVED_TRANSMISSION_BYTES(MAX_TRANSMISSION_LENGTH) + 1)
+
 void i2cSlave_initialize(void);
 void i2cSlave_shutdown(void);
 
@@ -13,9 +21,23 @@ void i2cSlave_eventHandler(void);
 // returned bytes via two out parameters, and returns true if the data includes the final byte of the message. A return
 // value of false with a returned data length of zero indicates that there is no data to read.
 bool i2cSlave_read(uint8_t max_data_length, uint8_t* data_out, uint8_t* data_length_out);
+// Read one message from the master in place, without copying it. Returns where to read the message and its length.
+// Returns zero if there is no message to read. The message stays in the queue until i2cSlave_release is called
+uint8_t i2cSlave_peek(circular_buffer_span_t* message_out);
+// Discard the message returned by i2cSlave_peek
+void i2cSlave_release(void);
 // Queue data to be sent to the master. This data is not organized into distinct messages. The master determines how
 // many bytes to read at a time. Delimiting messages, if desired, must be done by the caller and coordinated between the
-// master and slave software. The given data is copied into an internal buffer
+// master and slave software. The given data is copied into an internal frame, so can be at most I2C_SLAVE_FRAME_SIZE
+// bytes
 void i2cSlave_write(uint8_t* data, uint8_t data_length);
+// Zero-copy writes. Allocate a frame, fill it in place, then queue it to be sent to the master as with i2cSlave_write.
+// The frame is freed once it has been sent. Allocation is fatal if all frames are in use
+frame_handle_t i2cSlave_allocateFrame(void);
+// Same as i2cSlave_allocateFrame, except returns FRAME_POOL_NO_FRAME if all frames are in use
+frame_handle_t i2cSlave_tryAllocateFrame(void);
+uint8_t* i2cSlave_getFrame(frame_handle_t frame);
+// Queue the first length bytes of the given frame to be sent. Ownership of the frame passes to the I2C module
+void i2cSlave_writeFrame(frame_handle_t frame, uint8_t length);
 
 #endif /* I2CMASTER_H */
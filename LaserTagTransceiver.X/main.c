@@ -44,37 +44,167 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>  // for memcpy
 #include <xc.h>
 
+// What to drop when the main processor doesn't read received transmissions as fast as they arrive, so that every I2C
+// frame is in use. If defined, each time a new transmission is dropped for want of a slot in the receiver, the oldest
+// transmission still waiting for a frame is dropped too, to make room for the next one, so the latest hits get through.
+// Otherwise new transmissions are dropped until a frame is free, so hits are registered in the order they arrived.
+// Either way the receiver keeps working, and the drops are counted
+#undef DROP_OLDEST_ON_OVERLOAD
+
 static void receiveDataOverIR()
 {
+    // Decode straight into an I2C frame, which is kept across calls until a whole transmission has been received
+    static frame_handle_t received_frame = FRAME_POOL_NO_FRAME;
+    if (received_frame == FRAME_POOL_NO_FRAME)
+        received_frame = i2cSlave_tryAllocateFrame();
+
+#ifdef DROP_OLDEST_ON_OVERLOAD
+    // Only drop a waiting transmission once the receiver has needed a slot and found none, rather than on every pass
+    // while the frames are in use, which would drop transmissions that the main processor could still have read
+    static uint8_t seen_no_free_slot_count = 0;
+    uint8_t no_free_slot_count = irReceiver_getFailureCount(IR_RECEIVE_FAILURE_NO_FREE_SLOT);
+    bool needed_slot = no_free_slot_count != seen_no_free_slot_count;
+    seen_no_free_slot_count = no_free_slot_count;
+#endif
+
+    if (received_frame == FRAME_POOL_NO_FRAME)
+    {
+        // Leaving transmissions in the receiver drops new ones when its queue fills up
+#ifdef DROP_OLDEST_ON_OVERLOAD
+        if (needed_slot)
+            irReceiver_dropOldestTransmission();
+#endif
+        return;
+    }
+
+    uint8_t* received_data = i2cSlave_getFrame(received_frame);
     uint8_t received_data_length;
-    static uint8_t received_data[NUM_BYTES(MAX_TRANSMISSION_LENGTH) + 1];
+#ifdef SOFT_DECISION
+    if (irReceiver_tryGetSoftTransmission(received_data + 1, &received_data_length))
+#else
     if (irReceiver_tryGetTransmission(received_data + 1, &received_data_length))
+#endif
     {
-        // Send the received transmission length and the data to the main processor
+        // Send the received transmission length and the data to the main processor, along with its reliability flags
+        // and sensor flags if they're enabled
         received_data[0] = received_data_length;
-        i2cSlave_write(received_data, NUM_BYTES(received_data_length) + 1);
+        i2cSlave_writeFrame(received_frame, RECEIVED_TRANSMISSION_BYTES(received_data_length) + 1);
+        received_frame = FRAME_POOL_NO_FRAME;
+    }
+}
+
+// The receive failure counts that have already been reported to the main processor
+static uint8_t g_reported_failure_counts[TRANSCEIVER_RECEIVE_FAILURE_COUNT];
+
+static void reportReceiveFailures()
+{
+    uint8_t new_failure_counts[TRANSCEIVER_RECEIVE_FAILURE_COUNT];
+    bool any_new_failures = false;
+    for (uint8_t cause = 0; cause < TRANSCEIVER_RECEIVE_FAILURE_COUNT; cause++)
+    {
+        // The counts wrap, so the difference is right as long as fewer than 256 failures happen between reports
+        new_failure_counts[cause] = irReceiver_getFailureCount(cause) - g_reported_failure_counts[cause];
+        if (new_failure_counts[cause] != 0)
+            any_new_failures = true;
+    }
+
+    if (!any_new_failures)
+        return;
+
+    // If there's no free frame, the failures are reported on a later call instead
+    frame_handle_t frame = i2cSlave_tryAllocateFrame();
+    if (frame == FRAME_POOL_NO_FRAME)
+        return;
+
+    // Send the marker, then the number of new failures for each cause, in the order of ir_receive_failure_t
+    uint8_t* report = i2cSlave_getFrame(frame);
+    report[0] = RECEIVE_FAILURE_REPORT_MARKER;
+    for (uint8_t cause = 0; cause < TRANSCEIVER_RECEIVE_FAILURE_COUNT; cause++)
+    {
+        report[cause + 1] = new_failure_counts[cause];
+        g_reported_failure_counts[cause] += new_failure_counts[cause];
+    }
+    i2cSlave_writeFrame(frame, TRANSCEIVER_RECEIVE_FAILURE_COUNT + 1);
+}
+
+// True if the main processor has asked for a telemetry report that hasn't been sent yet
+static bool g_telemetry_requested = false;
+
+static void reportTelemetry()
+{
+    if (!g_telemetry_requested)
+        return;
+
+    // If there's no free frame, the report is sent on a later call instead
+    frame_handle_t frame = i2cSlave_tryAllocateFrame();
+    if (frame == FRAME_POOL_NO_FRAME)
+        return;
+
+    // Send the marker, then the counts as laid out in memory
+    ir_receiver_telemetry_t telemetry;
+    irReceiver_getTelemetry(&telemetry);
+
+    // Same check as i2cSlave_write. Constant, so compiled out when the report fits
+    if (sizeof(telemetry) + 1 > I2C_SLAVE_FRAME_SIZE)
+        fatal(ERROR_I2C_OUTGOING_QUEUE_FULL);
+
+    uint8_t* report = i2cSlave_getFrame(frame);
+    report[0] = TELEMETRY_REPORT_MARKER;
+    memcpy(report + 1, &telemetry, sizeof(telemetry));
+    i2cSlave_writeFrame(frame, sizeof(telemetry) + 1);
+
+    g_telemetry_requested = false;
+}
+
+// Handle a message from the main processor that starts with a command rather than a transmission length
+static void handleCommand(uint8_t command)
+{
+    switch (command)
+    {
+        case TELEMETRY_REQUEST_COMMAND:
+            g_telemetry_requested = true;
+            break;
+
+        case TELEMETRY_RESET_COMMAND:
+            irReceiver_resetTelemetry();
+            break;
+
+        default:
+            fatal(ERROR_UNKNOWN_I2C_COMMAND);
     }
 }
 
 static void transmitDataOverIR()
 {
-    uint8_t i2c_message[NUM_BYTES(MAX_TRANSMISSION_LENGTH) + 1];
-    uint8_t i2c_message_length;
-    bool is_whole_message = i2cSlave_read(NUM_BYTES(MAX_TRANSMISSION_LENGTH) + 1, i2c_message, &i2c_message_length);
-    if (i2c_message_length != 0)
+    // Encode the message straight out of the I2C queue rather than copying it out first
+    circular_buffer_span_t i2c_message;
+    uint8_t i2c_message_length = i2cSlave_peek(&i2c_message);
+    if (i2c_message_length == 0)
+        return;
+
+    if (i2c_message_length > NUM_BYTES(MAX_TRANSMISSION_LENGTH) + 1)
+        fatal(ERROR_OUTGOING_IR_TRANSMISSION_TOO_LONG);
+
+    // Length in bits, or a command if it's too long to be a length
+    uint8_t transmission_length = circularBuffer_spanGet(&i2c_message, 0);
+    if (transmission_length > MAX_TRANSMISSION_LENGTH)
     {
-        if (!is_whole_message)
-        {
-            fatal(ERROR_OUTGOING_IR_TRANSMISSION_TOO_LONG);
-            // If we ever choose to ignore this error, we must flush the remainder of the message before proceeding
-        }
-
-        // Length in bits
-        uint8_t transmission_length = i2c_message[0];
-        irTransmitter_transmitAsync(i2c_message + 1, transmission_length);
+        handleCommand(transmission_length);
+        i2cSlave_release();
+        return;
     }
+
+    // The data after the length must hold every bit of it
+    if (i2c_message_length - 1 < NUM_BYTES(transmission_length))
+        fatal(ERROR_OUTGOING_IR_TRANSMISSION_TOO_SHORT);
+
+    // If the previous transmission is still being sent, leave the message in the queue to try again next time
+    circularBuffer_spanSkip(&i2c_message, 1);
+    if (irTransmitter_transmitSpanAsync(&i2c_message, transmission_length))
+        i2cSlave_release();
 }
 
 int main(void)
@@ -89,6 +219,8 @@ int main(void)
         i2cSlave_eventHandler();
 
         receiveDataOverIR();
+        reportReceiveFailures();
+        reportTelemetry();
         transmitDataOverIR();
     }
 }
@@ -1,13 +1,14 @@
 #ifndef PACKETSTATS_H
 #define PACKETSTATS_H
 
-#include "crcConstants.h"
+#include "../LaserTagUtils.X/fec.h"
 
 // Length of a data packet. This cannot be increased above 8 without code
 // changes
 #define PACKET_LENGTH 8
-// Length of the entire transmission container for a packet
-#define PACKET_TRANSMISSION_LENGTH ((PACKET_LENGTH) + CRC_LENGTH)
+// Length of the entire transmission container for a packet, a forward error
+// correction codeword
+#define PACKET_TRANSMISSION_LENGTH (FEC_CODEWORD_LENGTH)
 
 #define EVALUATE_CONSTANTS
 #ifdef EVALUATE_CONSTANTS
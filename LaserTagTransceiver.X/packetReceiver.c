@@ -1,35 +1,24 @@
 #include "packetReceiver.h"
 
+#include "../LaserTagUtils.X/bitArray.h"
+#include "../LaserTagUtils.X/fec.h"
 #include "IRReceiver.h"
-#include "crc.h"
-
-#include "crcConstants.h"
 #include "packetConstants.h"
+#include "transmissionConstants.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 
 bool tryGetPacket(uint8_t* packet_out)
 {
-    uint16_t transmission;
+    uint8_t transmission[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
     uint8_t transmission_length;
-    if (!tryGetTransmission(&transmission, &transmission_length))
+    if (!irReceiver_tryGetTransmission(transmission, &transmission_length))
         return false;
 
     if (transmission_length != PACKET_TRANSMISSION_LENGTH)
         return false;
 
-    uint8_t packet = transmission >> CRC_LENGTH;
-
-    uint8_t actual_crc = transmission & ((1 << CRC_LENGTH) - 1);
-    uint8_t expected_crc = crc(packet);
-
-    bool crc_matches = expected_crc == actual_crc;
-
-    if (crc_matches)
-    {
-        *packet_out = packet;
-    }
-
-    return crc_matches;
+    // Corrects up to two flipped bits
+    return fec_decode8(transmission, packet_out) != FEC_UNCORRECTABLE;
 }
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include "packetTransmitter.h"
 
+#include "../LaserTagUtils.X/fec.h"
 #include "IRTransmitter.h"
-#include "crc.h"
-#include "crcConstants.h"
 #include "packetConstants.h"
 
 #include <stdbool.h>
@@ -10,6 +9,8 @@
 
 bool transmitPacketAsync(uint8_t packet)
 {
-    // Append crc bits to the transmission
-    return transmitAsync(((int16_t)packet << CRC_LENGTH) | crc(packet), PACKET_TRANSMISSION_LENGTH);
+    // Encode the packet with forward error correction bits
+    uint8_t transmission[FEC_CODEWORD_BYTES];
+    fec_encode8(packet, transmission);
+    return irTransmitter_transmitAsync(transmission, PACKET_TRANSMISSION_LENGTH);
 }
\ No newline at end of file
@@ -6,7 +6,7 @@
 
 // Asynchronously transmits the given packet using IRTransmitter. If a
 // transmission is in progress, returns false and does nothing. Otherwise
-// returns true. Transmits with extra error checking bits
+// returns true. Transmits with forward error correction bits
 bool transmitPacketAsync(uint8_t packet);
 
 #endif /* PACKETTRANSMITTER_H */
@@ -11,6 +11,15 @@
 #define PPS_IN_VAL_IR_RECEIVER PPS_IN_VAL_RC3
 #define TRIS_IR_RECEIVER TRISC3
 
+// Second IR receiver pin, with DUAL_SENSOR
+#define PPS_IN_VAL_IR_RECEIVER_2 PPS_IN_VAL_RC4
+#define TRIS_IR_RECEIVER_2 TRISC4
+
+// Both IR receivers combined, with DUAL_SENSOR. Active while either receiver is. Driven by CLC3 and read back by TMR4
+#define PPS_IN_VAL_IR_RECEIVERS_COMBINED PPS_IN_VAL_RC0
+#define PPS_OUT_REG_IR_RECEIVERS_COMBINED PPS_OUT_REG_RC0
+#define TRIS_IR_RECEIVERS_COMBINED TRISC0
+
 // IR LED pin
 #define PPS_OUT_REG_IR_LED PPS_OUT_REG_RC5
 #define TRIS_IR_LED TRISC5
@@ -0,0 +1,286 @@
+// Simulation of two-sensor receive traces with DUAL_SENSOR, checking what IRReceiver.c queues when the two sensors'
+// channels decode the same transmission, different ones, or one of them fails:
+//
+// - Both sensors receive a transmission: it's queued once, flagged with both sensors
+// - One sensor's copy is damaged, before or after the other sensor's copy is complete: the good copy is queued for its
+//   sensor alone, not as an alternate, and the damaged one is counted as a failure
+// - The sensors decode different data, e.g. a bit error in one: both are queued, the second marked with
+//   ALTERNATE_TRANSMISSION_FLAG. If the queue only has room for the first, the alternate is dropped and counted
+// - With SOFT_DECISION, a bit that one sensor flagged as unreliable needn't match, and the copies are merged, taking
+//   the bit from the sensor that received it reliably
+// - A second shooter: sensor 1 receives shooter A's transmission while sensor 2 is still receiving shooter B's longer
+//   one. If B's pulses then reach sensor 1, the gap before them is too long to be a pulse gap, so A is discarded as
+//   IR_RECEIVE_FAILURE_INVALID_GAP and only B is queued. If they don't, A is queued, and B after it as its alternate,
+//   since they can't be told apart from one transmission that the sensors decoded differently
+//
+// With FRAME_HEADER, a transmission is queued as soon as it's complete, unless the other sensor is still receiving,
+// rather than at the long gap after it, so each scenario checks when its transmissions are queued too.
+//
+// Usage: dualSensorTest. Exits with a non-zero status if any check fails
+
+#include "irHarness.c"
+
+#ifndef DUAL_SENSOR
+#error "dualSensorTest needs DUAL_SENSOR"
+#endif
+
+// The length of the transmissions that the sensors both receive, and of shooter A's and shooter B's
+#define LENGTH 24
+#define SHOOTER_A_LENGTH 16
+#define SHOOTER_B_LENGTH 40
+
+// The pulses of shooter B's transmission that sensor 2 receives before shooter A's starts
+#define SHOOTER_B_LEAD 10
+
+static uint8_t g_data[NUM_BYTES(LENGTH)] = {0xC5, 0x3A, 0x96};
+// g_data with one bit flipped
+static uint8_t g_other_data[NUM_BYTES(LENGTH)] = {0xC5, 0x2A, 0x96};
+static uint8_t g_shooter_a_data[NUM_BYTES(SHOOTER_A_LENGTH)] = {0x5B, 0xE1};
+static uint8_t g_shooter_b_data[NUM_BYTES(SHOOTER_B_LENGTH)] = {0x0F, 0x72, 0xA4, 0x99, 0x3C};
+
+static ir_harness_trace_t g_trace;
+static ir_harness_trace_t g_other_trace;
+static ir_harness_trace_t g_shooter_a_trace;
+static ir_harness_trace_t g_shooter_b_trace;
+
+// Play two traces into the two sensors, alternating pulse by pulse, with the second starting lag pulses after the first
+static void receiveStaggered(const ir_harness_trace_t* first, uint8_t first_sensor, const ir_harness_trace_t* second,
+                             uint8_t second_sensor, uint8_t lag)
+{
+    for (uint16_t i = 0; i < first->length || i < second->length + lag; i++)
+    {
+        if (i < first->length)
+            irHarness_receivePulses(first, (uint8_t)i, 1, first_sensor);
+        if (i >= lag && i - lag < second->length)
+            irHarness_receivePulses(second, (uint8_t)(i - lag), 1, second_sensor);
+    }
+}
+
+// Check that exactly the given transmission is waiting to be collected, for the given sensors, and collect it
+static void checkReceived(const uint8_t* data, uint8_t length, uint8_t sensors)
+{
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_isData(&transmission, data, length));
+    IR_HARNESS_CHECK(transmission.sensors == sensors);
+}
+
+static void checkNothingReceived(void)
+{
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+}
+
+// Play the long gap that ends the transmissions. Without FRAME_HEADER, that's when they're queued
+static void endTransmissions(void)
+{
+#ifndef FRAME_HEADER
+    checkNothingReceived();
+#endif
+    irHarness_longGap();
+}
+
+static void testBothSensors(void)
+{
+    irHarness_describe("both sensors received a transmission");
+    irHarness_reset();
+
+    irHarness_receiveTrace(&g_trace, SENSOR_1_FLAG | SENSOR_2_FLAG);
+    endTransmissions();
+
+    checkReceived(g_data, LENGTH, SENSOR_1_FLAG | SENSOR_2_FLAG);
+    checkNothingReceived();
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 0);
+}
+
+// One sensor's copy has an overlapping pulse at damaged_pulse, and it starts lag pulses after the good copy, so with a
+// large enough lag, the good copy is complete before the damaged one fails
+static void testOneSensorFails(uint8_t good_sensor, uint8_t damaged_pulse, uint8_t lag)
+{
+    uint8_t damaged_sensor = good_sensor == SENSOR_1_FLAG ? SENSOR_2_FLAG : SENSOR_1_FLAG;
+    irHarness_describe("sensor %u's copy was damaged at pulse %u, %u pulses behind", damaged_sensor, damaged_pulse,
+                       lag);
+    irHarness_reset();
+
+    ir_harness_trace_t damaged = g_trace;
+    damaged.pulses[damaged_pulse].width = IR_HARNESS_OVERLAPPING_PULSE_WIDTH;
+    receiveStaggered(&g_trace, good_sensor, &damaged, damaged_sensor, lag);
+
+    // With FRAME_HEADER, the good copy is queued as soon as it's complete, unless the damaged copy was still being
+    // received then, in which case it waited for it, and is queued at the long gap. It's not an alternate either way,
+    // since it's the only copy queued
+    bool queued_early = false;
+#ifdef FRAME_HEADER
+    queued_early = damaged_pulse + lag < g_trace.length - 1;
+#endif
+    if (queued_early)
+        checkReceived(g_data, LENGTH, good_sensor);
+    checkNothingReceived();
+
+    irHarness_longGap();
+    if (!queued_early)
+        checkReceived(g_data, LENGTH, good_sensor);
+    checkNothingReceived();
+    IR_HARNESS_CHECK(irReceiver_getFailureCount(IR_RECEIVE_FAILURE_OVERLAP) == 1);
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 1);
+}
+
+static void testSensorsDisagree(uint8_t queued_before)
+{
+    irHarness_describe("the sensors decoded different data, with %u transmissions queued", queued_before);
+    irHarness_reset();
+
+    // Fill the queue up to the given number of transmissions, which aren't collected until the end
+    for (uint8_t i = 0; i < queued_before; i++)
+    {
+        irHarness_receiveTrace(&g_shooter_a_trace, SENSOR_1_FLAG);
+        irHarness_longGap();
+    }
+
+    receiveStaggered(&g_trace, SENSOR_1_FLAG, &g_other_trace, SENSOR_2_FLAG, 0);
+    irHarness_longGap();
+
+    for (uint8_t i = 0; i < queued_before; i++)
+        checkReceived(g_shooter_a_data, SHOOTER_A_LENGTH, SENSOR_1_FLAG);
+
+    uint8_t free_slots = RECEIVED_TRANSMISSIONS_QUEUE_LENGTH - 1 - queued_before;
+    if (free_slots >= 1)
+        checkReceived(g_data, LENGTH, SENSOR_1_FLAG);
+    if (free_slots >= 2)
+        checkReceived(g_other_data, LENGTH, SENSOR_2_FLAG | ALTERNATE_TRANSMISSION_FLAG);
+    checkNothingReceived();
+
+    uint8_t dropped = free_slots >= 2 ? 0 : 2 - free_slots;
+    IR_HARNESS_CHECK(irReceiver_getFailureCount(IR_RECEIVE_FAILURE_NO_FREE_SLOT) == dropped);
+    IR_HARNESS_CHECK(irHarness_failureTotal() == dropped);
+}
+
+#if defined(SOFT_DECISION) && !defined(TRAINING_PREAMBLE) && !defined(GAP_MODULATION)
+// The index of the pulse that carries the given bit of the data, when each pulse is one bit
+static uint8_t dataPulseIndex(uint8_t bit)
+{
+#ifdef FRAME_HEADER
+    return FRAME_HEADER_LENGTH + bit;
+#else
+    return bit;
+#endif
+}
+
+// One sensor decodes a one as an unreliable zero. The copies are merged, taking the bit from the other sensor
+static void testUnreliableBitMerged(uint8_t unreliable_sensor)
+{
+    // The second bit of the data is a one
+    const uint8_t bit = 1;
+
+    irHarness_describe("sensor %u decoded bit %u as an unreliable zero", unreliable_sensor, bit);
+    irHarness_reset();
+
+    ir_harness_trace_t unreliable = g_trace;
+    unreliable.pulses[dataPulseIndex(bit)].width = ZERO_PULSE_LENGTH_UPPER_BOUND_SMT1_CYCLES;
+    if (unreliable_sensor == SENSOR_1_FLAG)
+        receiveStaggered(&unreliable, SENSOR_1_FLAG, &g_trace, SENSOR_2_FLAG, 0);
+    else
+        receiveStaggered(&g_trace, SENSOR_1_FLAG, &unreliable, SENSOR_2_FLAG, 0);
+    endTransmissions();
+
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_isData(&transmission, g_data, LENGTH));
+    IR_HARNESS_CHECK(irHarness_isReliable(&transmission));
+    IR_HARNESS_CHECK(transmission.sensors == (SENSOR_1_FLAG | SENSOR_2_FLAG));
+    checkNothingReceived();
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 0);
+}
+#endif
+
+// Sensor 1 receives shooter A's transmission while sensor 2 is receiving shooter B's. Then, if b_reaches_sensor_1,
+// the rest of B's transmission reaches sensor 1 as well
+static void testSecondShooter(bool b_reaches_sensor_1)
+{
+    irHarness_describe("a second shooter's transmission %s sensor 1", b_reaches_sensor_1 ? "reached" : "missed");
+    irHarness_reset();
+
+    irHarness_receivePulses(&g_shooter_b_trace, 0, SHOOTER_B_LEAD, SENSOR_2_FLAG);
+
+    // The rest of B's transmission, after the pulses that were received alongside A's
+    ir_harness_trace_t b_rest = g_shooter_b_trace;
+    uint8_t b_received = SHOOTER_B_LEAD + g_shooter_a_trace.length;
+    b_rest.length = g_shooter_b_trace.length - b_received;
+    for (uint8_t i = 0; i < b_rest.length; i++)
+        b_rest.pulses[i] = g_shooter_b_trace.pulses[b_received + i];
+
+    ir_harness_trace_t b_during_a = g_shooter_b_trace;
+    b_during_a.length = g_shooter_a_trace.length;
+    for (uint8_t i = 0; i < b_during_a.length; i++)
+        b_during_a.pulses[i] = g_shooter_b_trace.pulses[SHOOTER_B_LEAD + i];
+
+    receiveStaggered(&g_shooter_a_trace, SENSOR_1_FLAG, &b_during_a, SENSOR_2_FLAG, 0);
+
+    // A is complete, but sensor 2 is still receiving, so nothing is queued yet even with FRAME_HEADER
+    checkNothingReceived();
+
+    if (b_reaches_sensor_1)
+    {
+        // Sensor 1 has been silent since the end of A
+        ir_harness_trace_t b_rest_on_sensor_1 = b_rest;
+        b_rest_on_sensor_1.pulses[0].gap = IR_HARNESS_LONG_GAP;
+        receiveStaggered(&b_rest_on_sensor_1, SENSOR_1_FLAG, &b_rest, SENSOR_2_FLAG, 0);
+    }
+    else
+    {
+        irHarness_receivePulses(&b_rest, 0, b_rest.length, SENSOR_2_FLAG);
+    }
+    endTransmissions();
+
+    if (b_reaches_sensor_1)
+    {
+        checkReceived(g_shooter_b_data, SHOOTER_B_LENGTH, SENSOR_2_FLAG);
+        IR_HARNESS_CHECK(irReceiver_getFailureCount(IR_RECEIVE_FAILURE_INVALID_GAP) == 1);
+        IR_HARNESS_CHECK(irHarness_failureTotal() == 1);
+    }
+    else
+    {
+        checkReceived(g_shooter_a_data, SHOOTER_A_LENGTH, SENSOR_1_FLAG);
+        checkReceived(g_shooter_b_data, SHOOTER_B_LENGTH, SENSOR_2_FLAG | ALTERNATE_TRANSMISSION_FLAG);
+        IR_HARNESS_CHECK(irHarness_failureTotal() == 0);
+    }
+    checkNothingReceived();
+}
+
+int main(void)
+{
+    irHarness_describe("recording the traces");
+    irHarness_reset();
+    irHarness_transmit(g_data, LENGTH, 0, &g_trace);
+    irHarness_transmit(g_other_data, LENGTH, 0, &g_other_trace);
+    irHarness_transmit(g_shooter_a_data, SHOOTER_A_LENGTH, 0, &g_shooter_a_trace);
+    irHarness_transmit(g_shooter_b_data, SHOOTER_B_LENGTH, 0, &g_shooter_b_trace);
+    if (g_shooter_b_trace.length <= SHOOTER_B_LEAD + g_shooter_a_trace.length)
+    {
+        printf("FAILED: shooter B's transmission must outlast shooter A's\n");
+        return 1;
+    }
+
+    testBothSensors();
+
+    // Damaged part way through, or on the last pulse, behind the good copy or alongside it
+    for (uint8_t good_sensor = SENSOR_1_FLAG; good_sensor <= SENSOR_2_FLAG; good_sensor <<= 1)
+    {
+        testOneSensorFails(good_sensor, g_trace.length / 2, 0);
+        testOneSensorFails(good_sensor, g_trace.length - 1, 0);
+        testOneSensorFails(good_sensor, g_trace.length - 1, 2);
+    }
+
+    for (uint8_t queued_before = 0; queued_before < RECEIVED_TRANSMISSIONS_QUEUE_LENGTH; queued_before++)
+        testSensorsDisagree(queued_before);
+
+#if defined(SOFT_DECISION) && !defined(TRAINING_PREAMBLE) && !defined(GAP_MODULATION)
+    testUnreliableBitMerged(SENSOR_1_FLAG);
+    testUnreliableBitMerged(SENSOR_2_FLAG);
+#endif
+
+    testSecondShooter(true);
+    testSecondShooter(false);
+
+    return irHarness_finish();
+}
@@ -0,0 +1,316 @@
+// Host harness for the IR transmitter and receiver. IRTransmitter.c and IRReceiver.c are included here, built against
+// the stand-in xc.h in this directory, so that a test can drive them the way the hardware would:
+//
+// - irHarness_transmit starts a transmission and records the pulses that the transmitter queued for it as a trace,
+//   i.e. each pulse's width and the gap before it, as a sensor with the given bias would make SMT1 measure them
+// - irHarness_receivePulse plays one measured pulse into a sensor's SMT interrupt, and irHarness_longGap plays the
+//   TMR4 interrupt for the silence that ends a transmission. Traces are played pulse by pulse, so a test can interleave
+//   two sensors' pulses in any order, or edit a trace to damage it
+//
+// Time isn't modelled beyond the order of the interrupts: a test decides when the long gap comes, and what gap each
+// sensor measured before each of its pulses.
+//
+// Each test includes this file rather than linking against it, since the firmware's sources and constants headers are
+// written to be built into a program once, and the test needs the options that they were built with. See Makefile
+
+#define XC_HOST_DEFINE_REGISTERS
+#include <xc.h>
+
+#include "IRReceiver.c"
+#include "IRTransmitter.c"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// The most pulses in a trace. Every pulse takes a pulse width and a gap width in the transmitter's queue
+#define IR_HARNESS_MAX_PULSES (OUTGOING_PULSE_WIDTHS_STORAGE_SIZE / 2)
+
+// The gap that SMT1 measures before the first pulse of a transmission, or any pulse after a long silence. It stops
+// counting at SMT1PR
+#define IR_HARNESS_LONG_GAP 0xFE
+
+// The bias of the sensor's output, in SMT1 cycles, that the receiver is designed to accept: each pulse up to this much
+// longer or shorter, and the gap after it as much shorter or longer. With TRAINING_PREAMBLE, the pulse widths are
+// only far enough apart for the sensor's specified bias
+#ifdef TRAINING_PREAMBLE
+#define IR_HARNESS_MAX_BIAS \
+    ((int)((RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_SPEC_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10) - 1)
+#define IR_HARNESS_MIN_BIAS \
+    (1 - (int)((RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_SPEC_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10))
+#else
+#define IR_HARNESS_MAX_BIAS \
+    ((int)((RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10) - 1)
+#define IR_HARNESS_MIN_BIAS \
+    (1 - (int)((RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10) * (SMT1_MOD_FREQ_RATIO) / 10))
+#endif
+
+// Nominal widths, in SMT1 cycles, for building or editing traces by hand
+#define IR_HARNESS_ZERO_PULSE_WIDTH ((ZERO_PULSE_LENGTH_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO))
+#define IR_HARNESS_ONE_PULSE_WIDTH ((ONE_PULSE_LENGTH_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO))
+#define IR_HARNESS_PULSE_GAP_WIDTH ((PULSE_GAP_LENGTH_MOD_CYCLES) * (SMT1_MOD_FREQ_RATIO))
+// A pulse too long to be any level, as when another transmitter's pulse runs into one of ours
+#define IR_HARNESS_OVERLAPPING_PULSE_WIDTH 0xF0
+
+#define IR_HARNESS_CHECK(condition) irHarness_check((condition), #condition, __FILE__, __LINE__)
+
+// One pulse as a sensor's SMT measures it, in SMT1 cycles
+typedef struct
+{
+    // The gap since the end of the previous pulse
+    uint8_t gap;
+    uint8_t width;
+} ir_harness_pulse_t;
+
+typedef struct
+{
+    uint8_t length;
+    ir_harness_pulse_t pulses[IR_HARNESS_MAX_PULSES];
+} ir_harness_trace_t;
+
+// A transmission collected from the receiver, in the layout that irReceiver_tryGetTransmission copies it out in, split
+// into its parts
+typedef struct
+{
+    uint8_t length;
+    uint8_t data[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+    // All zero without SOFT_DECISION
+    uint8_t unreliable[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+    // SENSOR_1_FLAG without DUAL_SENSOR
+    uint8_t sensors;
+} ir_harness_transmission_t;
+
+static unsigned long g_harness_checks;
+static unsigned long g_harness_failures;
+// Printed with each failed check, to say what the test was doing
+static char g_harness_context[128];
+
+void fatal(uint16_t error_code)
+{
+    printf("FAILED: fatal error %u while %s\n", error_code, g_harness_context);
+    exit(1);
+}
+
+// Set the description printed with any failed check until the next call
+void irHarness_describe(const char* format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(g_harness_context, sizeof(g_harness_context), format, arguments);
+    va_end(arguments);
+}
+
+void irHarness_check(bool passed, const char* condition, const char* file, int line)
+{
+    g_harness_checks++;
+    if (passed)
+        return;
+
+    g_harness_failures++;
+    printf("FAILED %s:%d: %s, while %s\n", file, line, condition, g_harness_context);
+}
+
+// Print the result of the checks. Returns the test's exit status
+int irHarness_finish(void)
+{
+    if (g_harness_failures != 0)
+    {
+        printf("%lu of %lu checks failed\n", g_harness_failures, g_harness_checks);
+        return 1;
+    }
+
+    printf("passed %lu checks\n", g_harness_checks);
+    return 0;
+}
+
+// Start afresh: both modules initialized, nothing received, and every failure count zero
+void irHarness_reset(void)
+{
+    irTransmitter_initialize();
+    irReceiver_initialize();
+
+    for (uint8_t i = 0; i < TRANSCEIVER_RECEIVE_FAILURE_COUNT; i++)
+        g_failure_counts[i] = 0;
+    g_telemetry = (ir_receiver_telemetry_t){0};
+}
+
+// A width queued for the transmitter as it would be measured by SMT1 from a sensor with the given bias. The
+// transmitter queues each pulse as its length in TMR2 cycles and each gap as one less than its length, so a pulse is
+// measured as its queued width and a gap as one more
+static uint8_t measure(uint8_t queued_width, bool is_gap, int bias)
+{
+    int width = (queued_width + (is_gap ? 1 : 0)) / (TMR2_MOD_CLOCK_RATIO) * (SMT1_MOD_FREQ_RATIO);
+    width += is_gap ? -bias : bias;
+
+    if (width <= 0 || width >= IR_HARNESS_LONG_GAP)
+    {
+        printf("FAILED: bias %d makes a width of %u unmeasurable, while %s\n", bias, queued_width, g_harness_context);
+        exit(1);
+    }
+
+    return (uint8_t)width;
+}
+
+// Transmit the given data, and record the pulses that the transmitter queued as they'd be measured by a sensor with
+// the given bias. Leaves the transmitter idle, ready for the next transmission
+void irHarness_transmit(uint8_t* data, uint8_t length, int bias, ir_harness_trace_t* trace_out)
+{
+    if (!irTransmitter_transmitAsync(data, length))
+    {
+        printf("FAILED: transmitter busy, while %s\n", g_harness_context);
+        exit(1);
+    }
+
+    // Starting the transmission took the first pulse width from the queue and put it in PR2. The rest follow as gap
+    // and pulse width pairs, then the end of transmission gap
+    trace_out->length = 1;
+    trace_out->pulses[0].gap = IR_HARNESS_LONG_GAP;
+    trace_out->pulses[0].width = measure(PR2, false, bias);
+
+    uint8_t gap;
+    uint8_t width;
+    while (spscQueue_pop(&g_outgoing_pulse_widths, &gap) && gap != 0xFF)
+    {
+        if (!spscQueue_pop(&g_outgoing_pulse_widths, &width))
+        {
+            printf("FAILED: the transmission ended on a gap, while %s\n", g_harness_context);
+            exit(1);
+        }
+
+        ir_harness_pulse_t* pulse = &trace_out->pulses[trace_out->length++];
+        pulse->gap = measure(gap, true, bias);
+        pulse->width = measure(width, false, bias);
+    }
+
+    IR_HARNESS_CHECK(spscQueue_size(&g_outgoing_pulse_widths) == 0);
+    endTransmission();
+}
+
+// Play the end of one pulse into the given sensor's SMT interrupt. The sensor is SENSOR_1_FLAG or SENSOR_2_FLAG
+void irHarness_receivePulse(uint8_t sensor, uint8_t gap, uint8_t width)
+{
+    if (sensor == SENSOR_1_FLAG)
+    {
+        SMT1CPRL = gap;
+        SMT1CPWL = width;
+        SMT1PWAIF = 1;
+    }
+    else
+    {
+#ifdef DUAL_SENSOR
+        SMT2CPRL = gap;
+        SMT2CPWL = width;
+        SMT2PWAIF = 1;
+#else
+        printf("FAILED: no second sensor without DUAL_SENSOR, while %s\n", g_harness_context);
+        exit(1);
+#endif
+    }
+
+    irReceiver_interruptHandler();
+}
+
+// Play the given number of a trace's pulses into one sensor, starting with the pulse at first
+void irHarness_receivePulses(const ir_harness_trace_t* trace, uint8_t first, uint8_t count, uint8_t sensor)
+{
+    for (uint8_t i = first; i < first + count; i++)
+        irHarness_receivePulse(sensor, trace->pulses[i].gap, trace->pulses[i].width);
+}
+
+// Play a whole trace into each of the given sensors, as a mask of SENSOR_ flags, a pulse at a time, as when they all
+// see the same transmission at once
+void irHarness_receiveTrace(const ir_harness_trace_t* trace, uint8_t sensors)
+{
+    for (uint8_t i = 0; i < trace->length; i++)
+    {
+        if (sensors & SENSOR_1_FLAG)
+            irHarness_receivePulses(trace, i, 1, SENSOR_1_FLAG);
+        if (sensors & SENSOR_2_FLAG)
+            irHarness_receivePulses(trace, i, 1, SENSOR_2_FLAG);
+    }
+}
+
+// Play the TMR4 period match that a long enough silence on every sensor causes
+void irHarness_longGap(void)
+{
+    TMR4IF = 1;
+    irReceiver_interruptHandler();
+}
+
+// Collect the next received transmission, if any
+bool irHarness_tryGetTransmission(ir_harness_transmission_t* transmission_out)
+{
+    uint8_t buffer[RECEIVED_TRANSMISSION_BYTES(MAX_TRANSMISSION_LENGTH)];
+    uint8_t length;
+#ifdef SOFT_DECISION
+    if (!irReceiver_tryGetSoftTransmission(buffer, &length))
+        return false;
+#else
+    if (!irReceiver_tryGetTransmission(buffer, &length))
+        return false;
+#endif
+
+    uint8_t num_bytes = NUM_BYTES(length);
+    *transmission_out = (ir_harness_transmission_t){.length = length, .sensors = SENSOR_1_FLAG};
+    for (uint8_t i = 0; i < num_bytes; i++)
+    {
+        transmission_out->data[i] = buffer[i];
+#ifdef SOFT_DECISION
+        transmission_out->unreliable[i] = buffer[num_bytes + i];
+#endif
+    }
+#ifdef DUAL_SENSOR
+    transmission_out->sensors = buffer[RECEIVED_TRANSMISSION_DATA_BYTES(length)];
+#endif
+
+    return true;
+}
+
+// True if the transmission is the given data. Bits after the end of the data are ignored
+bool irHarness_isData(const ir_harness_transmission_t* transmission, const uint8_t* data, uint8_t length)
+{
+    if (transmission->length != length)
+        return false;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint8_t mask = (uint8_t)(0x80 >> (i & 7));
+        if ((transmission->data[i >> 3] & mask) != (data[i >> 3] & mask))
+            return false;
+    }
+
+    return true;
+}
+
+// True if no bit of the transmission is flagged as unreliable
+bool irHarness_isReliable(const ir_harness_transmission_t* transmission)
+{
+    for (uint8_t i = 0; i < NUM_BYTES(transmission->length); i++)
+    {
+        if (transmission->unreliable[i] != 0)
+            return false;
+    }
+
+    return true;
+}
+
+// The number of transmissions discarded for any cause
+uint16_t irHarness_failureTotal(void)
+{
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < TRANSCEIVER_RECEIVE_FAILURE_COUNT; i++)
+        total += irReceiver_getFailureCount(i);
+    return total;
+}
+
+// xorshift32, for test data that's the same on every run
+uint8_t irHarness_random(void)
+{
+    static uint32_t state = 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (uint8_t)state;
+}
@@ -0,0 +1,239 @@
+// Round trip test of the IR transmitter and receiver. Random data of every length that can be sent, odd and even, is
+// transmitted, played into the receiver as measured from a sensor of every bias that the receiver is designed for,
+// and checked:
+//
+// - The transmitter sends the expected number of pulses: one for each bit, after the training preamble and frame
+//   header if any, or with MULTI_LEVEL_SYMBOLS, two for each symbol, the last padded out with zeros. With
+//   GAP_MODULATION, one for every two bits, the second sent in the gap after it, and one more: a zero pulse added to
+//   the end when the bits come to an even number, or the last bit's own pulse when they don't
+// - The receiver decodes exactly the data sent, with no failures. With FRAME_HEADER, the transmission is queued as
+//   soon as its last pulse arrives, and otherwise only at the long gap after it. With SOFT_DECISION, no bit of a
+//   transmission received without bias is flagged as unreliable. With DUAL_SENSOR, both sensors receive it, and it's
+//   queued once. With GAP_MODULATION, the zero pulse added to the end is dropped, so data of odd and even lengths
+//   alike comes back at its own length
+//
+// With FRAME_HEADER, it also checks that a transmission with a bad delimiter is discarded as soon as the delimiter
+// doesn't match, that one cut short anywhere is discarded as truncated, and that pulses after a complete transmission
+// are ignored. With GAP_MODULATION and without FRAME_HEADER, it checks that one cut short before any of its data is
+// discarded as truncated. With TRAINING_PREAMBLE, one cut short in its preamble is discarded as having an invalid
+// preamble.
+//
+// Usage: irLoopbackTest. Exits with a non-zero status if any check fails
+
+#include "irHarness.c"
+
+#ifdef TRAINING_PREAMBLE
+#define PREAMBLE_PULSES (TRAINING_PREAMBLE_LENGTH)
+#else
+#define PREAMBLE_PULSES 0
+#endif
+
+#ifdef DUAL_SENSOR
+#define SENSORS (SENSOR_1_FLAG | SENSOR_2_FLAG)
+#else
+#define SENSORS (SENSOR_1_FLAG)
+#endif
+
+// The length of the transmission that's cut short, damaged or followed by more pulses
+#define DAMAGED_LENGTH 17
+
+// The number of pulses that the transmitter should send for a transmission of the given length
+static uint8_t expectedPulseCount(uint8_t length)
+{
+    uint8_t bits = length;
+#ifdef FRAME_HEADER
+    bits += FRAME_HEADER_LENGTH;
+#elif defined(GAP_MODULATION)
+    // The bit saying whether a zero pulse was added to the end
+    bits += 1;
+#endif
+
+#if defined(GAP_MODULATION)
+    uint8_t pulses = (uint8_t)(bits / 2 + 1);
+#elif defined(MULTI_LEVEL_SYMBOLS)
+    uint8_t pulses = (uint8_t)((bits + SYMBOL_LENGTH - 1) / SYMBOL_LENGTH * 2);
+#else
+    uint8_t pulses = bits;
+#endif
+
+    return PREAMBLE_PULSES + pulses;
+}
+
+static void randomData(uint8_t* data_out, uint8_t length)
+{
+    for (uint8_t i = 0; i < NUM_BYTES(length); i++)
+        data_out[i] = irHarness_random();
+}
+
+static void testRoundTrip(uint8_t length, int bias)
+{
+    irHarness_describe("sending %u bits with a bias of %d", length, bias);
+
+    uint8_t data[NUM_BYTES(MAX_TRANSMISSION_LENGTH)];
+    randomData(data, length);
+
+    ir_harness_trace_t trace;
+    irHarness_transmit(data, length, bias, &trace);
+    IR_HARNESS_CHECK(trace.length == expectedPulseCount(length));
+
+    irHarness_receiveTrace(&trace, SENSORS);
+
+    ir_harness_transmission_t transmission;
+#ifdef FRAME_HEADER
+    IR_HARNESS_CHECK(irHarness_tryGetTransmission(&transmission));
+    irHarness_longGap();
+#else
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+    irHarness_longGap();
+    IR_HARNESS_CHECK(irHarness_tryGetTransmission(&transmission));
+#endif
+
+    IR_HARNESS_CHECK(irHarness_isData(&transmission, data, length));
+    IR_HARNESS_CHECK(transmission.sensors == SENSORS);
+    if (bias == 0)
+        IR_HARNESS_CHECK(irHarness_isReliable(&transmission));
+
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 0);
+}
+
+#if defined(FRAME_HEADER) || defined(GAP_MODULATION)
+// Receive the trace's pulses up to the given one, then the long gap, and check that it was discarded for the given
+// cause
+static void testCutShort(const ir_harness_trace_t* trace, uint8_t pulse_count, ir_receive_failure_t expected_cause)
+{
+    irHarness_describe("receiving %u of %u pulses", pulse_count, trace->length);
+    irHarness_reset();
+
+    irHarness_receivePulses(trace, 0, pulse_count, SENSOR_1_FLAG);
+    irHarness_longGap();
+
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irReceiver_getFailureCount(expected_cause) == 1);
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 1);
+}
+
+// Why a transmission cut short after the given number of pulses is discarded
+static ir_receive_failure_t cutShortCause(uint8_t pulse_count)
+{
+#ifdef TRAINING_PREAMBLE
+    if (pulse_count < TRAINING_PREAMBLE_LENGTH)
+        return IR_RECEIVE_FAILURE_INVALID_PREAMBLE;
+#else
+    (void)pulse_count;
+#endif
+    return IR_RECEIVE_FAILURE_TRUNCATED;
+}
+#endif
+
+#ifdef FRAME_HEADER
+static void testCutShortAnywhere(void)
+{
+    uint8_t data[NUM_BYTES(DAMAGED_LENGTH)];
+    randomData(data, DAMAGED_LENGTH);
+
+    ir_harness_trace_t trace;
+    irHarness_describe("recording a transmission to cut short");
+    irHarness_reset();
+    irHarness_transmit(data, DAMAGED_LENGTH, 0, &trace);
+
+    for (uint8_t pulse_count = 1; pulse_count < trace.length; pulse_count++)
+        testCutShort(&trace, pulse_count, cutShortCause(pulse_count));
+}
+
+// The delimiter starts with a one, so a zero in its place is rejected there and then, before the long gap
+static void testBadDelimiter(void)
+{
+    uint8_t data[NUM_BYTES(DAMAGED_LENGTH)];
+    randomData(data, DAMAGED_LENGTH);
+
+    irHarness_describe("receiving a transmission whose delimiter starts with a zero");
+    irHarness_reset();
+
+    ir_harness_trace_t trace;
+    irHarness_transmit(data, DAMAGED_LENGTH, 0, &trace);
+#ifdef MULTI_LEVEL_SYMBOLS
+    // The first symbol is the delimiter's first three bits, 110, which is sent as a two then a zero. Make it a zero
+    // then a zero, 000
+    trace.pulses[PREAMBLE_PULSES].width = trace.pulses[PREAMBLE_PULSES + 1].width;
+    uint8_t rejected_after = PREAMBLE_PULSES + 2;
+#else
+    trace.pulses[PREAMBLE_PULSES].width = IR_HARNESS_ZERO_PULSE_WIDTH;
+    uint8_t rejected_after = PREAMBLE_PULSES + 1;
+#endif
+
+    irHarness_receivePulses(&trace, 0, rejected_after, SENSOR_1_FLAG);
+    IR_HARNESS_CHECK(irReceiver_getFailureCount(IR_RECEIVE_FAILURE_INVALID_HEADER) == 1);
+
+    // The rest of the transmission is ignored
+    irHarness_receivePulses(&trace, rejected_after, trace.length - rejected_after, SENSOR_1_FLAG);
+    irHarness_longGap();
+
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 1);
+}
+
+// Pulses after the declared length, e.g. from another transmitter, are ignored until the long gap
+static void testTrailingPulses(void)
+{
+    uint8_t data[NUM_BYTES(DAMAGED_LENGTH)];
+    randomData(data, DAMAGED_LENGTH);
+
+    irHarness_describe("receiving pulses after a complete transmission");
+    irHarness_reset();
+
+    ir_harness_trace_t trace;
+    irHarness_transmit(data, DAMAGED_LENGTH, 0, &trace);
+    irHarness_receiveTrace(&trace, SENSOR_1_FLAG);
+    irHarness_receiveTrace(&trace, SENSOR_1_FLAG);
+    irHarness_longGap();
+
+    ir_harness_transmission_t transmission;
+    IR_HARNESS_CHECK(irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_isData(&transmission, data, DAMAGED_LENGTH));
+    IR_HARNESS_CHECK(!irHarness_tryGetTransmission(&transmission));
+    IR_HARNESS_CHECK(irHarness_failureTotal() == 0);
+}
+#elif defined(GAP_MODULATION)
+// Without a header, a transmission cut short part way through its data can't be told from a shorter one, but one cut
+// short before any, i.e. with no more than the pulse of the bit saying whether a zero pulse was added, can. Tried with
+// odd and even lengths, so with and without that pulse added
+static void testCutShortBeforeData(void)
+{
+    for (uint8_t length = DAMAGED_LENGTH; length <= DAMAGED_LENGTH + 1; length++)
+    {
+        uint8_t data[NUM_BYTES(DAMAGED_LENGTH + 1)];
+        randomData(data, length);
+
+        ir_harness_trace_t trace;
+        irHarness_describe("recording a transmission of %u bits to cut short", length);
+        irHarness_reset();
+        irHarness_transmit(data, length, 0, &trace);
+
+        for (uint8_t pulse_count = 1; pulse_count <= PREAMBLE_PULSES + 1; pulse_count++)
+            testCutShort(&trace, pulse_count, cutShortCause(pulse_count));
+    }
+}
+#endif
+
+int main(void)
+{
+    irHarness_reset();
+    for (uint8_t length = 1; length <= MAX_TRANSMISSION_LENGTH; length++)
+    {
+        for (int bias = IR_HARNESS_MIN_BIAS; bias <= IR_HARNESS_MAX_BIAS; bias++)
+            testRoundTrip(length, bias);
+    }
+
+#ifdef FRAME_HEADER
+    testCutShortAnywhere();
+    testBadDelimiter();
+    testTrailingPulses();
+#elif defined(GAP_MODULATION)
+    testCutShortBeforeData();
+#endif
+
+    return irHarness_finish();
+}
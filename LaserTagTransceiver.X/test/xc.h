@@ -0,0 +1,135 @@
+#ifndef XC_H
+#define XC_H
+
+#include <stdint.h>
+
+// Stands in for the xc8 device header when the IR transmitter and receiver are built for the host. See irHarness.c.
+// Declares the registers and bits that IRTransmitter.c and IRReceiver.c use, with any option, as plain variables. The
+// harness defines them by defining XC_HOST_DEFINE_REGISTERS before including this, and sets the ones that the receiver
+// reads to play the part of the hardware
+
+#ifdef XC_HOST_DEFINE_REGISTERS
+#define XC_HOST_REGISTER volatile
+#else
+#define XC_HOST_REGISTER extern volatile
+#endif
+
+#define __interrupt()
+#define NOP()
+
+// clang-format off
+// Oscillator, PPS and pins
+XC_HOST_REGISTER uint8_t CLCIN0PPS;
+XC_HOST_REGISTER uint8_t CLCIN2PPS;
+XC_HOST_REGISTER uint8_t CLCIN3PPS;
+XC_HOST_REGISTER uint8_t RC0PPS;
+XC_HOST_REGISTER uint8_t RC1PPS;
+XC_HOST_REGISTER uint8_t RC2PPS;
+XC_HOST_REGISTER uint8_t RC5PPS;
+XC_HOST_REGISTER uint8_t T2PPS;
+XC_HOST_REGISTER uint8_t T4PPS;
+XC_HOST_REGISTER uint8_t TRISC0;
+XC_HOST_REGISTER uint8_t TRISC1;
+XC_HOST_REGISTER uint8_t TRISC2;
+XC_HOST_REGISTER uint8_t TRISC3;
+XC_HOST_REGISTER uint8_t TRISC4;
+XC_HOST_REGISTER uint8_t TRISC5;
+
+// CLC1 to CLC3
+XC_HOST_REGISTER struct { uint8_t LC1MODE; } CLC1CONbits;
+XC_HOST_REGISTER uint8_t CLC1GLS0;
+XC_HOST_REGISTER uint8_t CLC1GLS1;
+XC_HOST_REGISTER uint8_t CLC1GLS2;
+XC_HOST_REGISTER uint8_t CLC1GLS3;
+XC_HOST_REGISTER uint8_t CLC1SEL0;
+XC_HOST_REGISTER uint8_t CLC1SEL1;
+XC_HOST_REGISTER uint8_t LC1EN;
+XC_HOST_REGISTER uint8_t LC1G1POL;
+XC_HOST_REGISTER uint8_t LC1G2POL;
+XC_HOST_REGISTER uint8_t LC1G3POL;
+XC_HOST_REGISTER uint8_t LC1G4POL;
+XC_HOST_REGISTER uint8_t LC1POL;
+XC_HOST_REGISTER struct { uint8_t LC2MODE; } CLC2CONbits;
+XC_HOST_REGISTER uint8_t CLC2GLS0;
+XC_HOST_REGISTER uint8_t CLC2GLS1;
+XC_HOST_REGISTER uint8_t CLC2GLS2;
+XC_HOST_REGISTER uint8_t CLC2GLS3;
+XC_HOST_REGISTER uint8_t CLC2SEL0;
+XC_HOST_REGISTER uint8_t CLC2SEL1;
+XC_HOST_REGISTER uint8_t LC2EN;
+XC_HOST_REGISTER uint8_t LC2G1POL;
+XC_HOST_REGISTER uint8_t LC2G2POL;
+XC_HOST_REGISTER uint8_t LC2G3POL;
+XC_HOST_REGISTER uint8_t LC2G4POL;
+XC_HOST_REGISTER uint8_t LC2POL;
+XC_HOST_REGISTER struct { uint8_t LC3MODE; } CLC3CONbits;
+XC_HOST_REGISTER uint8_t CLC3GLS0;
+XC_HOST_REGISTER uint8_t CLC3GLS1;
+XC_HOST_REGISTER uint8_t CLC3GLS2;
+XC_HOST_REGISTER uint8_t CLC3GLS3;
+XC_HOST_REGISTER uint8_t CLC3SEL0;
+XC_HOST_REGISTER uint8_t CLC3SEL1;
+XC_HOST_REGISTER uint8_t LC3EN;
+XC_HOST_REGISTER uint8_t LC3G1POL;
+XC_HOST_REGISTER uint8_t LC3G2POL;
+XC_HOST_REGISTER uint8_t LC3G3POL;
+XC_HOST_REGISTER uint8_t LC3G4POL;
+XC_HOST_REGISTER uint8_t LC3POL;
+
+// PWM3, TMR2 and TMR6, for the transmitter
+XC_HOST_REGISTER struct { uint8_t P3TSEL; } CCPTMRSbits;
+XC_HOST_REGISTER uint16_t PWM3DC;
+XC_HOST_REGISTER uint8_t PWM3EN;
+XC_HOST_REGISTER struct { uint8_t CS; } T2CLKCONbits;
+XC_HOST_REGISTER uint8_t PR2;
+XC_HOST_REGISTER uint8_t T2PSYNC;
+XC_HOST_REGISTER uint8_t TMR2;
+XC_HOST_REGISTER uint8_t TMR2IE;
+XC_HOST_REGISTER uint8_t TMR2IF;
+XC_HOST_REGISTER uint8_t TMR2ON;
+XC_HOST_REGISTER struct { uint8_t CS; } T6CLKCONbits;
+XC_HOST_REGISTER uint8_t T6PR;
+XC_HOST_REGISTER uint8_t TMR6;
+XC_HOST_REGISTER uint8_t TMR6IE;
+XC_HOST_REGISTER uint8_t TMR6ON;
+
+// SMT1, SMT2 and TMR4, for the receiver
+XC_HOST_REGISTER struct { uint8_t EN; uint8_t SMT1PS; uint8_t SPOL; uint8_t STP; } SMT1CON0bits;
+XC_HOST_REGISTER struct { uint8_t MODE; } SMT1CON1bits;
+XC_HOST_REGISTER uint8_t SMT1CLK;
+XC_HOST_REGISTER uint8_t SMT1CPRL;
+XC_HOST_REGISTER uint8_t SMT1CPWL;
+XC_HOST_REGISTER uint8_t SMT1GO;
+XC_HOST_REGISTER uint8_t SMT1IE;
+XC_HOST_REGISTER uint32_t SMT1PR;
+XC_HOST_REGISTER uint8_t SMT1PWAIE;
+XC_HOST_REGISTER uint8_t SMT1PWAIF;
+XC_HOST_REGISTER uint8_t SMT1REPEAT;
+XC_HOST_REGISTER uint8_t SMT1SIG;
+XC_HOST_REGISTER uint8_t SMT1SIGPPS;
+XC_HOST_REGISTER uint32_t SMT1TMR;
+XC_HOST_REGISTER struct { uint8_t EN; uint8_t SMT2PS; uint8_t SPOL; uint8_t STP; } SMT2CON0bits;
+XC_HOST_REGISTER struct { uint8_t MODE; } SMT2CON1bits;
+XC_HOST_REGISTER uint8_t SMT2CLK;
+XC_HOST_REGISTER uint8_t SMT2CPRL;
+XC_HOST_REGISTER uint8_t SMT2CPWL;
+XC_HOST_REGISTER uint8_t SMT2GO;
+XC_HOST_REGISTER uint8_t SMT2IE;
+XC_HOST_REGISTER uint32_t SMT2PR;
+XC_HOST_REGISTER uint8_t SMT2PWAIE;
+XC_HOST_REGISTER uint8_t SMT2PWAIF;
+XC_HOST_REGISTER uint8_t SMT2REPEAT;
+XC_HOST_REGISTER uint8_t SMT2SIG;
+XC_HOST_REGISTER uint8_t SMT2SIGPPS;
+XC_HOST_REGISTER uint32_t SMT2TMR;
+XC_HOST_REGISTER struct { uint8_t CS; } T4CLKCONbits;
+XC_HOST_REGISTER struct { uint8_t CKPS; } T4CONbits;
+XC_HOST_REGISTER struct { uint8_t MODE; } T4HLTbits;
+XC_HOST_REGISTER struct { uint8_t RSEL; } T4RSTbits;
+XC_HOST_REGISTER uint8_t T4PR;
+XC_HOST_REGISTER uint8_t TMR4IE;
+XC_HOST_REGISTER uint8_t TMR4IF;
+XC_HOST_REGISTER uint8_t TMR4ON;
+// clang-format on
+
+#endif /* XC_H */
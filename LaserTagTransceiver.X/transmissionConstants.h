@@ -1,9 +1,104 @@
 #ifndef TRANSMISSIONCONSTANTS_H
 #define TRANSMISSIONCONSTANTS_H
 
+#include "../LaserTagUtils.X/bitArray.h"
+#include "../LaserTagUtils.X/irLinkProtocol.h"
 #include "IRReceiverStats.h"
 #include "crcConstants.h"
 
+// Prepend a training preamble to every transmission. The receiver measures the
+// widths of the preamble's zero and one pulses and decodes the rest of the
+// transmission against them, rather than against fixed windows that are
+// widened to cover the receiver's bias at any irradiance. This lets the pulse
+// lengths be based on the receiver's specified bias range instead of the
+// widened one. Every transceiver must agree on this setting
+#undef TRAINING_PREAMBLE
+
+// Start every transmission with a header: a start-of-frame delimiter, which is
+// a fixed pattern of bits, then the length of the transmission. The receiver
+// discards a transmission as soon as a bit doesn't match the delimiter, so
+// noise is rejected at its first few pulses. It also finishes a transmission as
+// soon as its declared length has arrived, rather than at the long gap after
+// it, so the main processor gets it sooner. Transmissions of any length can be
+// mixed. The header follows the training preamble, if there is one, and isn't
+// part of the transmission's data or length. Every transceiver must agree on
+// this setting
+#undef FRAME_HEADER
+
+// Send three bits in every pair of pulses, rather than one bit in each pulse,
+// by giving each pulse one of three widths: a zero, a one, or a two, which is
+// as much longer than a one as a one is than a zero. Pulses must be shorter
+// than RECEIVER_PULSE_MAX_CYCLES, which leaves room for three widths only with
+// the spacing that the training preamble allows, and the last symbol of a
+// transmission is padded with zeros, so this implies TRAINING_PREAMBLE and
+// FRAME_HEADER. The preamble and header make short transmissions longer than
+// with neither, but long ones are shorter. Average airtime with random data,
+// in modulation cycles, and bursts, for a transmission of each length:
+//
+//     Bits | Neither     | TRAINING_PREAMBLE | MULTI_LEVEL_SYMBOLS
+//          |             | and FRAME_HEADER  |
+//       17 |  376 /  17  |  631 /  32        |  554 /  24
+//       32 |  698 /  32  |  916 /  47        |  764 /  34
+//       64 | 1386 /  64  | 1540 /  79        | 1213 /  54
+//      120 | 2590 / 120  | 2653 / 135        | 2105 /  92
+//
+// Every transceiver must agree on this setting
+#undef MULTI_LEVEL_SYMBOLS
+
+// Send a bit in the gap after every pulse of a transmission's data, as well as
+// in the pulse, by making the gap either a pulse gap or a pulse gap plus
+// GAP_LENGTH_MIN_DIFF_MOD_CYCLES. The gaps are never shorter than the receiver
+// allows, and nearly every burst carries two bits, so transmissions take about
+// half the bursts, and the receiver can take more of them per second. A
+// transmission can't end on a gap, so if its bits would, a zero pulse is added
+// to the end. Without FRAME_HEADER, a transmission's data is preceded by a bit
+// saying whether that pulse was added, so that the receiver can drop it. Not
+// compatible with MULTI_LEVEL_SYMBOLS. Every transceiver must agree on this
+// setting
+#undef GAP_MODULATION
+
+#ifdef MULTI_LEVEL_SYMBOLS
+#define TRAINING_PREAMBLE
+#define FRAME_HEADER
+
+// The number of bits in a symbol, which is sent as two pulses, most
+// significant bit first. The pulse widths for each symbol, as the levels of
+// its first and second pulses, where 0 is a zero, 1 a one and 2 a two:
+//
+//     000: 0 0    001: 0 1    011: 0 2    111: 1 2
+//     101: 2 2    100: 2 1    110: 2 0    010: 1 0
+//
+// Each symbol differs by one bit from those either side of it, which are the
+// symbols a pulse one level off turns it into, so most pulse errors cost one
+// bit. Two ones is never sent, so is an invalid pulse
+#define SYMBOL_LENGTH 3
+#endif
+
+#ifdef FRAME_HEADER
+// The start-of-frame delimiter, sent most significant bit first. It mixes ones
+// and zeros, so that a run of identical pulses doesn't match it, and starts
+// with a one, so that it can't be confused with the end of a training preamble
+#define START_OF_FRAME_DELIMITER 0b1101
+#define START_OF_FRAME_DELIMITER_LENGTH 4
+// The number of bits in the length, sent after the delimiter, most significant
+// bit first. Must be enough for MAX_TRANSMISSION_LENGTH
+#define FRAME_LENGTH_FIELD_LENGTH 7
+#define FRAME_HEADER_LENGTH ((START_OF_FRAME_DELIMITER_LENGTH) + (FRAME_LENGTH_FIELD_LENGTH))
+#endif
+
+#ifdef TRAINING_PREAMBLE
+// The number of pulses in the preamble. They alternate zero and one, starting
+// with zero. The receiver averages each pair, so this must be 4
+#define TRAINING_PREAMBLE_LENGTH 4
+
+// The bias of each transmission is measured, so the pulse lengths only need to
+// be distinguishable under the specified bias range
+#define PULSE_LENGTH_MIN_DIFF_MOD_CYCLES                               \
+    ((((RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_SPEC_MOD_CYCLES_x10)    \
+       + (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_SPEC_MOD_CYCLES_x10)) \
+      / 10)                                                            \
+     + 1)
+#else
 // The minimum difference between two pulse lengths to guarantee that they can
 // be unambiguously distinguished by the receiver
 #define PULSE_LENGTH_MIN_DIFF_MOD_CYCLES                          \
@@ -11,20 +106,49 @@
        + (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10)) \
       / 10)                                                       \
      + 1)
+#endif
 
 // Pulse lengths in terms of modulation cycles
 #define ZERO_PULSE_LENGTH_MOD_CYCLES (RECEIVER_PULSE_MIN_CYCLES)
 #define ONE_PULSE_LENGTH_MOD_CYCLES ((ZERO_PULSE_LENGTH_MOD_CYCLES) + (PULSE_LENGTH_MIN_DIFF_MOD_CYCLES))
+#ifdef MULTI_LEVEL_SYMBOLS
+#define TWO_PULSE_LENGTH_MOD_CYCLES ((ONE_PULSE_LENGTH_MOD_CYCLES) + (PULSE_LENGTH_MIN_DIFF_MOD_CYCLES))
+#define LONGEST_PULSE_LENGTH_MOD_CYCLES (TWO_PULSE_LENGTH_MOD_CYCLES)
+#else
+#define LONGEST_PULSE_LENGTH_MOD_CYCLES (ONE_PULSE_LENGTH_MOD_CYCLES)
+#endif
 #define PULSE_GAP_LENGTH_MOD_CYCLES (RECEIVER_GAP_MIN_CYCLES)
 
+#ifdef GAP_MODULATION
+// The receiver shortens a gap by as much as it lengthens the pulse before it,
+// and the other way around, so the gap lengths for a zero and a one must be as
+// far apart as fixed windows for pulse lengths are. Gaps aren't trained on, so
+// this is the case even with TRAINING_PREAMBLE
+#define GAP_LENGTH_MIN_DIFF_MOD_CYCLES                            \
+    ((((RECEIVER_PULSE_LENGTH_BIAS_LOWER_BOUND_MOD_CYCLES_x10)    \
+       + (RECEIVER_PULSE_LENGTH_BIAS_UPPER_BOUND_MOD_CYCLES_x10)) \
+      / 10)                                                       \
+     + 1)
+
+// A pulse gap is a zero, and this is a one
+#define ONE_GAP_LENGTH_MOD_CYCLES ((PULSE_GAP_LENGTH_MOD_CYCLES) + (GAP_LENGTH_MIN_DIFF_MOD_CYCLES))
+
+// Minimum gap between distinct transmissions in modulation cycles. Half a
+// pulse gap longer than a one gap, truncated to nearest integer number of
+// cycles. It must still fit in an 8-bit measurement by SMT1
+#define MIN_TRANSMISSION_GAP_LENGTH_MOD_CYCLES ((ONE_GAP_LENGTH_MOD_CYCLES) + ((PULSE_GAP_LENGTH_MOD_CYCLES) >> 1))
+#else
 // Minimum gap between distinct transmissions in modulation cycles. 2x pulse
 // gap, truncated to nearest integer number of cycles
 #define MIN_TRANSMISSION_GAP_LENGTH_MOD_CYCLES (2 * (PULSE_GAP_LENGTH_MOD_CYCLES))
+#endif
 
 #define MODULATION_FREQ (RECEIVER_MODULATION_FREQ)
 
-// Max transmission length in bits
-#define MAX_TRANSMISSION_LENGTH 120
+// The transmission length, the markers and commands sent in its place,
+// SOFT_DECISION and DUAL_SENSOR are shared with the main processor. See
+// irLinkProtocol.h. With DUAL_SENSOR, SMT1 measures the first sensor and SMT2
+// the second
 
 /*
  * A zero pulse is 10 modulation cycles
@@ -51,7 +175,11 @@
 const volatile uint8_t PULSE_LENGTH_MIN_DIFF_MOD_CYCLES_eval = PULSE_LENGTH_MIN_DIFF_MOD_CYCLES;
 const volatile uint8_t ZERO_PULSE_LENGTH_MOD_CYCLES_eval = ZERO_PULSE_LENGTH_MOD_CYCLES;
 const volatile uint8_t ONE_PULSE_LENGTH_MOD_CYCLES_eval = ONE_PULSE_LENGTH_MOD_CYCLES;
+const volatile uint8_t LONGEST_PULSE_LENGTH_MOD_CYCLES_eval = LONGEST_PULSE_LENGTH_MOD_CYCLES;
 const volatile uint8_t PULSE_GAP_LENGTH_MOD_CYCLES_eval = PULSE_GAP_LENGTH_MOD_CYCLES;
+#ifdef GAP_MODULATION
+const volatile uint8_t ONE_GAP_LENGTH_MOD_CYCLES_eval = ONE_GAP_LENGTH_MOD_CYCLES;
+#endif
 const volatile uint8_t MIN_TRANSMISSION_GAP_LENGTH_MOD_CYCLES_eval = MIN_TRANSMISSION_GAP_LENGTH_MOD_CYCLES;
 const volatile uint32_t MODULATION_FREQ_eval = MODULATION_FREQ;
 const volatile uint8_t MAX_TRANSMISSION_LENGTH_eval = MAX_TRANSMISSION_LENGTH;
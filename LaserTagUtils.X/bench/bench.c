@@ -0,0 +1,155 @@
+// Host-native benchmarks for the utility library. The library is compiled with the host compiler, so times are only
+// good for comparing one version or configuration with another, not for predicting times on a PIC16.
+//
+// Built normally, this reports nanoseconds per operation, the best of several timed runs.
+//
+// Built with BENCH_COUNT_CALLS, and the library built with -finstrument-functions, this instead reports how many calls
+// each operation makes to functions of the library that have external linkage. That's a proxy for PIC cycles that
+// doesn't depend on the host: xc8 makes each of those calls with a CALL and RETURN and a level of the 16-level hardware
+// stack, while it inlines static inline functions. Calls to static functions in the library's source files aren't
+// counted, so the proxy under-counts the work done by functions that have them, e.g. keyedLaneQueue_pushPartial.
+//
+// Usage: bench [filter]. Only benchmarks whose group or name contains the filter are run
+
+#define _GNU_SOURCE
+
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef BENCH_COUNT_CALLS
+#include <dlfcn.h>
+#else
+#include <time.h>
+#endif
+
+volatile uint8_t g_bench_sink;
+
+static const benchmark_group_t* const g_groups[] = {
+    &g_utils_benchmarks,
+    &g_queue_compare_benchmarks,
+    &g_fec_benchmarks,
+};
+
+#ifdef BENCH_COUNT_CALLS
+// Operations run for each count. Enough to average out operations that vary, e.g. by where a queue wraps
+#define COUNTED_OPERATIONS 256
+
+static uint32_t g_call_count;
+
+// Called by the instrumented library on entry to every function, including those that the host compiler inlined.
+// Functions with external linkage are the ones the dynamic linker knows by name, given -rdynamic. dladdr finds the
+// nearest exported symbol at or below an address, so a function only counts if it starts at that symbol
+void __cyg_profile_func_enter(void* function, void* call_site) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void* function, void* call_site) __attribute__((no_instrument_function));
+
+void __cyg_profile_func_enter(void* function, void* call_site)
+{
+    (void)call_site;
+
+    Dl_info info;
+    if (dladdr(function, &info) != 0 && info.dli_saddr == function)
+        g_call_count++;
+}
+
+void __cyg_profile_func_exit(void* function, void* call_site)
+{
+    (void)function;
+    (void)call_site;
+}
+
+static double measure(const benchmark_t* benchmark)
+{
+    if (benchmark->setup)
+        benchmark->setup();
+
+    g_call_count = 0;
+    benchmark->run(COUNTED_OPERATIONS);
+
+    return (double)g_call_count / COUNTED_OPERATIONS;
+}
+
+#define RESULT_HEADING "calls/op"
+#else
+// Runs shorter than this are repeated with more operations, so that the clock's resolution doesn't matter
+#define MIN_RUN_NS 20000000.0
+// The best of this many runs is reported, since anything else running on the host only ever slows a run down
+#define RUNS 5
+
+static double elapsedNs(struct timespec* start, struct timespec* end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+static double timeRun(const benchmark_t* benchmark, uint32_t count)
+{
+    struct timespec start;
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    benchmark->run(count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return elapsedNs(&start, &end);
+}
+
+static double measure(const benchmark_t* benchmark)
+{
+    if (benchmark->setup)
+        benchmark->setup();
+
+    uint32_t count = 1000;
+    while (timeRun(benchmark, count) < MIN_RUN_NS && count < 0x40000000)
+        count <<= 1;
+
+    double best_ns = timeRun(benchmark, count);
+    for (int i = 1; i < RUNS; i++)
+    {
+        double ns = timeRun(benchmark, count);
+        if (ns < best_ns)
+            best_ns = ns;
+    }
+
+    return best_ns / count;
+}
+
+#define RESULT_HEADING "ns/op"
+#endif
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    printf("%-70s %10s\n", "benchmark", RESULT_HEADING);
+
+    for (size_t i = 0; i < sizeof(g_groups) / sizeof(g_groups[0]); i++)
+    {
+        const benchmark_group_t* group = g_groups[i];
+        bool group_matches = strstr(group->name, filter) != NULL;
+        bool printed_heading = false;
+
+        for (const benchmark_t* benchmark = group->benchmarks; benchmark->name; benchmark++)
+        {
+            if (!group_matches && strstr(benchmark->name, filter) == NULL)
+                continue;
+
+            if (!printed_heading)
+            {
+                printf("\n%s\n", group->name);
+                printed_heading = true;
+            }
+
+            double result = measure(benchmark);
+
+            char label[80];
+            snprintf(label, sizeof(label), "%s, per %s", benchmark->name, benchmark->unit);
+            printf("  %-68s %10.2f\n", label, result);
+            fflush(stdout);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+// A benchmark is an operation on the utility library, run over and over on state that its setup function prepares. An
+// operation must leave the state as it found it, e.g. push a byte and pop it again, so that every run measures the
+// same thing however many times it repeats
+typedef struct
+{
+    // Shown in the report, along with the unit that an operation is counted in
+    const char* name;
+    const char* unit;
+    // Prepare the state the operation runs on. May be null
+    void (*setup)(void);
+    // Run the operation the given number of times
+    void (*run)(uint32_t count);
+} benchmark_t;
+
+// A group of benchmarks, shown together in the report. The list ends with an entry whose name is null
+typedef struct
+{
+    const char* name;
+    const benchmark_t* benchmarks;
+} benchmark_group_t;
+
+// The groups, in the order they're run. Each is defined in its own source file
+extern const benchmark_group_t g_utils_benchmarks;
+extern const benchmark_group_t g_queue_compare_benchmarks;
+extern const benchmark_group_t g_fec_benchmarks;
+
+// Written by benchmarks with the results of operations that would otherwise be optimized away
+extern volatile uint8_t g_bench_sink;
+
+#endif /* BENCH_H */
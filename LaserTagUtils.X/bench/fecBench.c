@@ -0,0 +1,96 @@
+// Benchmarks of the forward error correction codec, for codewords with each number of errors that it handles
+// differently
+
+#include "bench.h"
+
+#include "../fec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The data that every codeword encodes. Decoding costs the same whatever the data, since it only looks at syndromes
+#define DATA 0xA5
+
+static uint8_t g_codeword[FEC_CODEWORD_BYTES];
+static uint8_t g_erasures[FEC_CODEWORD_BYTES];
+
+// Encode DATA, then flip the bits of the given masks
+static void setupCodeword(uint8_t flips0, uint8_t flips1, uint8_t flips2)
+{
+    fec_encode8(DATA, g_codeword);
+    g_codeword[0] ^= flips0;
+    g_codeword[1] ^= flips1;
+    g_codeword[2] ^= flips2;
+
+    for (uint8_t i = 0; i < FEC_CODEWORD_BYTES; i++)
+        g_erasures[i] = 0;
+}
+
+static void setupNoErrors(void)
+{
+    setupCodeword(0, 0, 0);
+}
+
+// One data bit and one parity bit
+static void setupTwoErrors(void)
+{
+    setupCodeword(0x10, 0x02, 0);
+}
+
+// Detected, but not corrected
+static void setupThreeErrors(void)
+{
+    setupCodeword(0x10, 0x02, 0x80);
+}
+
+// One error and three erasures, the most erasures that still leave room for an error. One erased bit is wrong
+static void setupErrorAndErasures(void)
+{
+    setupCodeword(0x41, 0, 0);
+    g_erasures[0] = 0x01;
+    g_erasures[1] = 0x84;
+}
+
+// Four erasures, every one of which is wrong
+static void setupFourErasures(void)
+{
+    setupCodeword(0x03, 0x30, 0);
+    g_erasures[0] = 0x03;
+    g_erasures[1] = 0x30;
+}
+
+static void runEncode(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        fec_encode8((uint8_t)i, g_codeword);
+    g_bench_sink = g_codeword[1];
+}
+
+static void runDecode(uint32_t count)
+{
+    uint8_t data = 0;
+    for (uint32_t i = 0; i < count; i++)
+        g_bench_sink = fec_decode8(g_codeword, &data);
+    g_bench_sink = data;
+}
+
+static void runDecodeWithErasures(uint32_t count)
+{
+    uint8_t data = 0;
+    for (uint32_t i = 0; i < count; i++)
+        g_bench_sink = fec_decode8WithErasures(g_codeword, g_erasures, &data);
+    g_bench_sink = data;
+}
+
+static const benchmark_t g_benchmarks[] = {
+    {"fec_encode8", "codeword", NULL, runEncode},
+    {"fec_decode8, no errors", "codeword", setupNoErrors, runDecode},
+    {"fec_decode8, 2 errors", "codeword", setupTwoErrors, runDecode},
+    {"fec_decode8, 3 errors, uncorrectable", "codeword", setupThreeErrors, runDecode},
+    {"fec_decode8WithErasures, no erasures", "codeword", setupTwoErrors, runDecodeWithErasures},
+    {"fec_decode8WithErasures, 1 error and 3 erasures", "codeword", setupErrorAndErasures, runDecodeWithErasures},
+    {"fec_decode8WithErasures, 4 erasures", "codeword", setupFourErasures, runDecodeWithErasures},
+    {0},
+};
+
+const benchmark_group_t g_fec_benchmarks = {"Forward error correction", g_benchmarks};
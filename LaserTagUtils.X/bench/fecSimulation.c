@@ -0,0 +1,137 @@
+// Simulation of shots received over a channel that flips each bit independently with a given probability, which
+// rises with range. For each bit error rate it reports the shots that would be registered:
+//
+// - CRC: the scheme that the codec replaced, 8 bits of data and a 5-bit CRC, which detects errors but can't correct
+//   them. Shots that arrive with no errors are registered. Errors the CRC misses would register the wrong data too,
+//   and aren't counted, so this is an upper bound
+// - FEC: fec_decode8. Shots decoded to the data that was sent are registered, and the shots decoded to other data,
+//   i.e. with more errors than the code can detect, are reported as wrong
+// - Erasures: fec_decode8WithErasures, given the bits that a soft-decision receiver flagged as unreliable. Flags are
+//   synthetic: each flipped bit is flagged with probability FLAG_ERROR_CHANCE, and each other bit with probability
+//   FLAG_CORRECT_CHANCE, since pulses near the edge of a window are the likeliest to have been misread
+//
+// The same random errors are used for each scheme, and the seed is fixed, so every run gives the same results.
+//
+// Usage: fecSimulation [shots]. Simulates the given number of shots at each bit error rate
+
+#include "../fec.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_SHOTS 200000UL
+// The length of a shot under the CRC scheme, in bits
+#define CRC_SHOT_LENGTH 13
+
+// The chances of flagging a flipped bit and a correct bit as unreliable, in tenths of a percent
+#define FLAG_ERROR_CHANCE 800
+#define FLAG_CORRECT_CHANCE 50
+
+// Bit error rates, in tenths of a percent
+static const uint16_t g_bit_error_rates[] = {5, 10, 20, 30, 50, 70, 100, 110, 150, 200};
+
+// xorshift32
+static uint32_t random32(void)
+{
+    static uint32_t state = 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// True with the given probability, in tenths of a percent
+static bool randomChance(uint16_t probability)
+{
+    return random32() % 1000 < probability;
+}
+
+// A mask of the given number of bits, each set with the given probability, in tenths of a percent
+static uint32_t randomErrors(uint8_t length, uint16_t probability)
+{
+    uint32_t errors = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (randomChance(probability))
+            errors |= 1UL << i;
+    }
+
+    return errors;
+}
+
+// Flip the bits of a codeword given by a mask, in which bit i is bit i of the codeword in transmission order
+static void applyErrors(uint8_t* codeword, uint32_t errors)
+{
+    for (uint8_t position = 0; position < FEC_CODEWORD_LENGTH; position++)
+    {
+        if (errors & (1UL << position))
+            codeword[position >> 3] ^= (uint8_t)(0x80 >> (position & 7));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long shots = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SHOTS;
+
+    printf("%-16s %14s %14s %14s %16s %16s\n", "bit error rate", "CRC correct", "FEC correct", "FEC wrong",
+           "erasures correct", "erasures wrong");
+
+    for (size_t i = 0; i < sizeof(g_bit_error_rates) / sizeof(g_bit_error_rates[0]); i++)
+    {
+        uint16_t rate = g_bit_error_rates[i];
+        unsigned long crc_correct = 0;
+        unsigned long fec_correct = 0;
+        unsigned long fec_wrong = 0;
+        unsigned long erasures_correct = 0;
+        unsigned long erasures_wrong = 0;
+
+        for (unsigned long shot = 0; shot < shots; shot++)
+        {
+            uint8_t data = (uint8_t)random32();
+            uint32_t errors = randomErrors(FEC_CODEWORD_LENGTH, rate);
+
+            // The CRC scheme's shots are shorter, so only see the errors in their first bits
+            if ((errors & ((1UL << CRC_SHOT_LENGTH) - 1)) == 0)
+                crc_correct++;
+
+            uint32_t flags = 0;
+            for (uint8_t position = 0; position < FEC_CODEWORD_LENGTH; position++)
+            {
+                bool is_error = (errors & (1UL << position)) != 0;
+                if (randomChance(is_error ? FLAG_ERROR_CHANCE : FLAG_CORRECT_CHANCE))
+                    flags |= 1UL << position;
+            }
+
+            uint8_t codeword[FEC_CODEWORD_BYTES];
+            fec_encode8(data, codeword);
+            applyErrors(codeword, errors);
+
+            uint8_t decoded;
+            if (fec_decode8(codeword, &decoded) != FEC_UNCORRECTABLE)
+            {
+                if (decoded == data)
+                    fec_correct++;
+                else
+                    fec_wrong++;
+            }
+
+            uint8_t erasures[FEC_CODEWORD_BYTES] = {0};
+            applyErrors(erasures, flags);
+            if (fec_decode8WithErasures(codeword, erasures, &decoded) != FEC_UNCORRECTABLE)
+            {
+                if (decoded == data)
+                    erasures_correct++;
+                else
+                    erasures_wrong++;
+            }
+        }
+
+        printf("%14.1f %% %12.2f %% %12.2f %% %12.3f %% %14.2f %% %14.3f %%\n", rate / 10.0,
+               100.0 * crc_correct / shots, 100.0 * fec_correct / shots, 100.0 * fec_wrong / shots,
+               100.0 * erasures_correct / shots, 100.0 * erasures_wrong / shots);
+    }
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Exhaustive test of the forward error correction codec against the code that fec.h says it implements. The parity
+// and correction tables in fec.c are precomputed, so this is what shows that they match that code.
+//
+// - Every codeword has the parity bits of the polynomial in fec.h, computed here independently of fec.c, and an even
+//   number of set bits
+// - Every two codewords differ in at least 6 bits
+// - For every data byte, every error of one or two bits is corrected, and every error of three bits is detected
+// - For every data byte, every combination of e errors and f erasures with 2e + f <= 5 is corrected, whatever the
+//   values of the erased bits, and fec_decode8WithErasures returns the number of bits that it changed
+//
+// Usage: fecTest. Exits with a non-zero status if any check fails
+
+#include "../fec.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// x^8 + x^5 + x^4 + x^3 + 1, including its most significant term
+#define GENERATOR 0x139
+// The most failures printed. Only the count of the rest is
+#define MAX_PRINTED_FAILURES 10
+
+// The set of bits of a codeword is represented here as a 17-bit mask, bit i of which is bit i of the codeword in
+// transmission order, i.e. the most significant bit of the first byte first
+#define ALL_BITS ((1UL << FEC_CODEWORD_LENGTH) - 1)
+
+static unsigned long g_failures;
+
+static void fail(const char* check, uint8_t data, uint32_t errors, uint32_t erasures, unsigned result)
+{
+    if (g_failures < MAX_PRINTED_FAILURES)
+    {
+        printf("FAILED %s: data 0x%02X, errors 0x%05lX, erasures 0x%05lX, result %u\n", check, data,
+               (unsigned long)errors, (unsigned long)erasures, result);
+    }
+    g_failures++;
+}
+
+static void toBytes(uint32_t mask, uint8_t* bytes_out)
+{
+    for (uint8_t i = 0; i < FEC_CODEWORD_BYTES; i++)
+        bytes_out[i] = 0;
+
+    for (uint8_t position = 0; position < FEC_CODEWORD_LENGTH; position++)
+    {
+        if (mask & (1UL << position))
+            bytes_out[position >> 3] |= (uint8_t)(0x80 >> (position & 7));
+    }
+}
+
+static uint8_t countSetBits(uint32_t mask)
+{
+    uint8_t count = 0;
+    for (; mask != 0; mask &= mask - 1)
+        count++;
+    return count;
+}
+
+// The remainder of data * x^8 divided by the generator, by long division
+static uint8_t expectedParity(uint8_t data)
+{
+    uint16_t remainder = (uint16_t)(data << 8);
+    for (int8_t bit = 15; bit >= 8; bit--)
+    {
+        if (remainder & (1U << bit))
+            remainder ^= (uint16_t)(GENERATOR << (bit - 8));
+    }
+
+    return (uint8_t)remainder;
+}
+
+static void testEncoding(void)
+{
+    if (!fec_tablesAreValid())
+        fail("fec_tablesAreValid", 0, 0, 0, 0);
+
+    for (uint16_t data = 0; data < 256; data++)
+    {
+        uint8_t codeword[FEC_CODEWORD_BYTES];
+        fec_encode8((uint8_t)data, codeword);
+
+        uint8_t set_bits = countSetBits(codeword[0]) + countSetBits(codeword[1]) + countSetBits(codeword[2]);
+        if (codeword[0] != data || codeword[1] != expectedParity((uint8_t)data) || (codeword[2] & 0x7F) != 0
+            || (set_bits & 1) != 0)
+        {
+            fail("encoding", (uint8_t)data, 0, 0, codeword[1]);
+        }
+    }
+}
+
+static void testMinimumDistance(void)
+{
+    uint8_t minimum = FEC_CODEWORD_LENGTH;
+    for (uint16_t a = 0; a < 256; a++)
+    {
+        uint8_t codeword_a[FEC_CODEWORD_BYTES];
+        fec_encode8((uint8_t)a, codeword_a);
+
+        for (uint16_t b = a + 1; b < 256; b++)
+        {
+            uint8_t codeword_b[FEC_CODEWORD_BYTES];
+            fec_encode8((uint8_t)b, codeword_b);
+
+            uint8_t distance = 0;
+            for (uint8_t i = 0; i < FEC_CODEWORD_BYTES; i++)
+                distance += countSetBits(codeword_a[i] ^ codeword_b[i]);
+            if (distance < minimum)
+                minimum = distance;
+        }
+    }
+
+    if (minimum != 6)
+        fail("minimum distance", 0, 0, 0, minimum);
+}
+
+// Every mask of up to three bits, built once
+static uint32_t g_small_masks[1 + 17 + 136 + 680];
+static uint16_t g_small_mask_count;
+
+static void buildSmallMasks(void)
+{
+    for (uint32_t mask = 0; mask <= ALL_BITS; mask++)
+    {
+        if (countSetBits(mask) <= 3)
+            g_small_masks[g_small_mask_count++] = mask;
+    }
+}
+
+static void testErrors(void)
+{
+    for (uint16_t data = 0; data < 256; data++)
+    {
+        uint8_t codeword[FEC_CODEWORD_BYTES];
+        fec_encode8((uint8_t)data, codeword);
+
+        for (uint16_t i = 0; i < g_small_mask_count; i++)
+        {
+            uint32_t errors = g_small_masks[i];
+            uint8_t error_count = countSetBits(errors);
+
+            uint8_t received[FEC_CODEWORD_BYTES];
+            toBytes(errors, received);
+            for (uint8_t j = 0; j < FEC_CODEWORD_BYTES; j++)
+                received[j] ^= codeword[j];
+
+            uint8_t decoded = 0;
+            uint8_t result = fec_decode8(received, &decoded);
+            if (error_count == 3 ? result != FEC_UNCORRECTABLE : result != error_count || decoded != data)
+                fail(error_count == 3 ? "3-bit error detection" : "error correction", (uint8_t)data, errors, 0, result);
+        }
+    }
+}
+
+static void testErasures(void)
+{
+    for (uint16_t data = 0; data < 256; data++)
+    {
+        uint8_t codeword[FEC_CODEWORD_BYTES];
+        fec_encode8((uint8_t)data, codeword);
+
+        for (uint32_t erasures = 1; erasures <= ALL_BITS; erasures++)
+        {
+            uint8_t erasure_count = countSetBits(erasures);
+            if (erasure_count > FEC_MAX_ERASURES)
+                continue;
+
+            uint8_t erasure_bytes[FEC_CODEWORD_BYTES];
+            toBytes(erasures, erasure_bytes);
+            // Bits after the end of the codeword must be ignored
+            erasure_bytes[FEC_CODEWORD_BYTES - 1] |= 0x7F;
+
+            for (uint16_t i = 0; i < g_small_mask_count; i++)
+            {
+                uint32_t errors = g_small_masks[i];
+                uint8_t error_count = countSetBits(errors);
+                if ((errors & erasures) != 0 || 2 * error_count + erasure_count > 5)
+                    continue;
+
+                // Every value of the erased bits, from all of them wrong to none of them
+                uint32_t wrong_erasures = erasures;
+                do
+                {
+                    uint8_t received[FEC_CODEWORD_BYTES];
+                    toBytes(errors | wrong_erasures, received);
+                    for (uint8_t j = 0; j < FEC_CODEWORD_BYTES; j++)
+                        received[j] ^= codeword[j];
+
+                    uint8_t decoded = 0;
+                    uint8_t result = fec_decode8WithErasures(received, erasure_bytes, &decoded);
+                    if (result != error_count + countSetBits(wrong_erasures) || decoded != data)
+                        fail("erasure correction", (uint8_t)data, errors | wrong_erasures, erasures, result);
+
+                    wrong_erasures = (wrong_erasures - 1) & erasures;
+                } while (wrong_erasures != erasures);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    buildSmallMasks();
+
+    testEncoding();
+    testMinimumDistance();
+    testErrors();
+    testErasures();
+
+    if (g_failures != 0)
+    {
+        printf("%lu failures\n", g_failures);
+        return 1;
+    }
+
+    printf("passed\n");
+    return 0;
+}
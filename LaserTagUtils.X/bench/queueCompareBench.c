@@ -0,0 +1,137 @@
+// Benchmarks of the mask-wrapped SpscQueue against a queue_t. Both have 64 bytes of storage, a power of two, so the
+// queue_t wraps its indices with a mask too. A queue_t with 63 bytes of storage, which wraps its indices by comparing
+// them with its length, shows what the mask saves.
+//
+// This file defines UTILS_STATIC_INLINE before including the library, whatever the configuration, so that queue_push
+// and queue_pop are compiled in full into the functions below rather than called. Each function is then the whole of
+// one push or pop, which "make instructions" disassembles and counts
+
+#ifndef UTILS_STATIC_INLINE
+#define UTILS_STATIC_INLINE
+#endif
+
+#include "bench.h"
+
+#include "../queue.h"
+#include "../spscQueue.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QUEUE_LENGTH 64
+
+static uint8_t g_circular_storage[QUEUE_LENGTH];
+static queue_t g_circular;
+static uint8_t g_unmasked_storage[QUEUE_LENGTH - 1];
+static queue_t g_unmasked;
+static SPSC_QUEUE_T(QUEUE_LENGTH) g_spsc;
+
+// One push or pop each, not inlined into the benchmarks so that they can be disassembled
+__attribute__((noinline)) bool benchCircularPush(uint8_t data)
+{
+    return queue_push(&g_circular, data);
+}
+
+__attribute__((noinline)) bool benchCircularPop(uint8_t* data_out)
+{
+    return queue_pop(&g_circular, data_out);
+}
+
+__attribute__((noinline)) bool benchUnmaskedPush(uint8_t data)
+{
+    return queue_push(&g_unmasked, data);
+}
+
+__attribute__((noinline)) bool benchUnmaskedPop(uint8_t* data_out)
+{
+    return queue_pop(&g_unmasked, data_out);
+}
+
+__attribute__((noinline)) bool benchSpscPush(uint8_t data)
+{
+    return spscQueue_push(&g_spsc, data);
+}
+
+__attribute__((noinline)) bool benchSpscPop(uint8_t* data_out)
+{
+    return spscQueue_pop(&g_spsc, data_out);
+}
+
+static void setupQueues(void)
+{
+    g_circular = queue_create(g_circular_storage, QUEUE_LENGTH);
+    g_unmasked = queue_create(g_unmasked_storage, QUEUE_LENGTH - 1);
+    spscQueue_initialize(&g_spsc);
+}
+
+// Push and pop a byte at a time, as the pulse width queues are used, so the indices wrap every 64 bytes
+static void runCircularPushPop(uint32_t count)
+{
+    uint8_t byte = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        benchCircularPush((uint8_t)i);
+        benchCircularPop(&byte);
+    }
+    g_bench_sink = byte;
+}
+
+static void runUnmaskedPushPop(uint32_t count)
+{
+    uint8_t byte = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        benchUnmaskedPush((uint8_t)i);
+        benchUnmaskedPop(&byte);
+    }
+    g_bench_sink = byte;
+}
+
+static void runSpscPushPop(uint32_t count)
+{
+    uint8_t byte = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        benchSpscPush((uint8_t)i);
+        benchSpscPop(&byte);
+    }
+    g_bench_sink = byte;
+}
+
+// Fill to capacity and drain, as when a burst of pulses arrives while the main loop is busy
+static void runCircularFillDrain(uint32_t count)
+{
+    uint8_t byte = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        while (benchCircularPush((uint8_t)i))
+            ;
+        while (benchCircularPop(&byte))
+            ;
+    }
+    g_bench_sink = byte;
+}
+
+static void runSpscFillDrain(uint32_t count)
+{
+    uint8_t byte = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        while (benchSpscPush((uint8_t)i))
+            ;
+        while (benchSpscPop(&byte))
+            ;
+    }
+    g_bench_sink = byte;
+}
+
+static const benchmark_t g_benchmarks[] = {
+    {"queue_t push and pop", "byte", setupQueues, runCircularPushPop},
+    {"queue_t push and pop, 63 bytes of storage", "byte", setupQueues, runUnmaskedPushPop},
+    {"SpscQueue push and pop", "byte", setupQueues, runSpscPushPop},
+    {"queue_t fill to capacity and drain", "63 bytes", setupQueues, runCircularFillDrain},
+    {"SpscQueue fill to capacity and drain", "63 bytes", setupQueues, runSpscFillDrain},
+    {0},
+};
+
+const benchmark_group_t g_queue_compare_benchmarks = {"Mask-wrapped SpscQueue vs queue_t", g_benchmarks};
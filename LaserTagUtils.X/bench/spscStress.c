@@ -0,0 +1,353 @@
+// Concurrency stress test of SpscQueue and of the typed queues, which make the same guarantees. Each queue is run with
+// a producer and a consumer in three ways:
+//
+// - Threads: a producer thread and a consumer thread push and pop as fast as they can. On a host with two or more
+//   cores they run at the same time, so they interleave at every point of a push and a pop far more often than an
+//   interrupt handler and the main loop would. On a single core they only interleave when the scheduler preempts one
+// - Interrupt producer: the main thread pops, and a timer signal interrupts it at arbitrary points to push a burst, as
+//   SMT1InterruptHandler pushes pulse widths for the main loop
+// - Interrupt consumer: the main thread pushes, and the timer signal pops a burst, as the transmitter's interrupt
+//   handler pops the pulse widths that the main loop queued
+//
+// The interrupt modes are the model of the PIC: one side runs to completion in the middle of the other, never the
+// other way round. They find ordering bugs on any host, e.g. a producer that publishes the back index before writing
+// the byte, or a consumer that reads a slot before checking that the queue isn't empty. Both were checked to fail.
+//
+// The producer pushes a running count. The consumer checks that it pops exactly that sequence, so that no byte is
+// lost, duplicated, reordered, or read before it is written. The typed queue carries pairs whose second half is the
+// complement of the first, so a pop that sees one half of a push without the other is caught too.
+//
+// The thread mode relies on the host keeping stores in order and loads in order, as x86 does. On hosts with weaker
+// ordering, e.g. ARM, volatile doesn't order accesses between cores, so a failure in that mode there says nothing about
+// the PIC, which has one core.
+//
+// Usage: spscStress [operations]. Each queue passes the given number of values in the thread mode, and a 50th as many
+// in each interrupt mode. Exits with a non-zero status if any check fails
+
+#define _XOPEN_SOURCE 700
+
+#include "../spscQueue.h"
+#include "../typedQueue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define DEFAULT_OPERATIONS 5000000UL
+// The interrupt modes pass this many times fewer values, since the interrupt side only runs once per timer period
+#define INTERRUPT_OPERATIONS_DIVISOR 50
+// Failed pushes or pops in a row before a thread yields, so that the other thread gets to run on a single-core host
+#define SPINS_BEFORE_YIELD 64
+// Microseconds between timer interrupts
+#define INTERRUPT_PERIOD_US 5
+// In the interrupt modes, the main thread spins for up to this many iterations between pushes or pops, standing in for
+// the rest of the main loop. Without it the main thread would do all of its pushes or pops straight after each
+// interrupt and then wait, so the regular timer would only ever interrupt it waiting
+#define MAX_MAIN_LOOP_WORK 256
+
+// The smallest queue, which is full or empty most often, and the size of the pulse width queue
+static SPSC_QUEUE_T(2) g_tiny_queue;
+static SPSC_QUEUE_T(64) g_queue;
+
+typedef struct
+{
+    uint8_t value;
+    uint8_t complement;
+} pair_t;
+
+TYPED_QUEUE_DEFINE(pair_queue_t, pairQueue, pair_t, 16)
+
+static pair_queue_t g_pair_queue;
+
+typedef enum
+{
+    TINY_QUEUE,
+    QUEUE,
+    PAIR_QUEUE,
+} queue_id_t;
+
+typedef enum
+{
+    THREADS,
+    INTERRUPT_PRODUCER,
+    INTERRUPT_CONSUMER,
+} stress_mode_t;
+
+static const char* const g_mode_names[] = {"threads", "interrupt producer", "interrupt consumer"};
+
+// The test in progress. Each field is written by only one side, so needs no more protection than the queue under test
+static struct
+{
+    queue_id_t queue;
+    stress_mode_t mode;
+    unsigned long operations;
+    // Written by the producer
+    volatile unsigned long pushed;
+    uint8_t next_value;
+    unsigned long full_pushes;
+    unsigned long interrupts;
+    // Written by the consumer
+    volatile unsigned long popped;
+    uint8_t expected_value;
+    unsigned long empty_pops;
+    unsigned long failures;
+    // The first failure, recorded rather than printed since it may be found in a signal handler
+    unsigned long first_failure_index;
+    uint8_t first_failure_expected;
+    uint8_t first_failure_value;
+    bool first_failure_torn;
+} g_test;
+
+static bool push(uint8_t value)
+{
+    switch (g_test.queue)
+    {
+        case TINY_QUEUE:
+            return spscQueue_push(&g_tiny_queue, value);
+        case QUEUE:
+            return spscQueue_push(&g_queue, value);
+        default:
+        {
+            pair_t pair = {value, (uint8_t)~value};
+            return pairQueue_push(&g_pair_queue, &pair);
+        }
+    }
+}
+
+// Pops a value and sets *intact_out to whether both halves of it came from the same push
+static bool pop(uint8_t* value_out, bool* intact_out)
+{
+    *intact_out = true;
+
+    switch (g_test.queue)
+    {
+        case TINY_QUEUE:
+            return spscQueue_pop(&g_tiny_queue, value_out);
+        case QUEUE:
+            return spscQueue_pop(&g_queue, value_out);
+        default:
+        {
+            pair_t pair;
+            if (!pairQueue_pop(&g_pair_queue, &pair))
+                return false;
+            *value_out = pair.value;
+            *intact_out = (uint8_t)(pair.value ^ pair.complement) == 0xFF;
+            return true;
+        }
+    }
+}
+
+// Push the next value of the sequence. Returns false if the queue is full
+static bool pushNext(void)
+{
+    if (!push(g_test.next_value))
+    {
+        g_test.full_pushes++;
+        return false;
+    }
+
+    g_test.next_value++;
+    g_test.pushed++;
+    return true;
+}
+
+// Pop a value and check that it's the next of the sequence. Returns false if the queue is empty
+static bool popNext(void)
+{
+    uint8_t value;
+    bool intact;
+    if (!pop(&value, &intact))
+    {
+        g_test.empty_pops++;
+        return false;
+    }
+
+    if (value != g_test.expected_value || !intact)
+    {
+        if (g_test.failures == 0)
+        {
+            g_test.first_failure_index = g_test.popped;
+            g_test.first_failure_expected = g_test.expected_value;
+            g_test.first_failure_value = value;
+            g_test.first_failure_torn = !intact;
+        }
+        g_test.failures++;
+        // Resynchronize, so that one slip doesn't fail every later check
+        g_test.expected_value = value;
+    }
+
+    g_test.expected_value++;
+    g_test.popped++;
+    return true;
+}
+
+// Spin for a pseudo-random time, so that the main thread's pushes or pops are spread across the time between
+// interrupts, and so interrupts land at every point of them
+static void doMainLoopWork(void)
+{
+    // xorshift32
+    static uint32_t state = 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    for (volatile uint32_t i = state % MAX_MAIN_LOOP_WORK; i != 0; i--)
+        ;
+}
+
+static void* produce(void* argument)
+{
+    (void)argument;
+
+    while (g_test.pushed != g_test.operations)
+    {
+        if (!pushNext() && (g_test.full_pushes % SPINS_BEFORE_YIELD) == 0)
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static void* consume(void* argument)
+{
+    (void)argument;
+
+    while (g_test.popped != g_test.operations)
+    {
+        if (!popNext() && (g_test.empty_pops % SPINS_BEFORE_YIELD) == 0)
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+// The timer signal handler. Pushes or pops a burst whose length cycles, so that interrupts find the queue in every
+// state from empty to full
+static void interruptHandler(int signal)
+{
+    (void)signal;
+
+    g_test.interrupts++;
+    unsigned long burst = 1 + (g_test.interrupts % 70);
+
+    for (unsigned long i = 0; i < burst; i++)
+    {
+        if (g_test.mode == INTERRUPT_PRODUCER)
+        {
+            if (g_test.pushed == g_test.operations || !pushNext())
+                break;
+        }
+        else
+        {
+            if (g_test.popped == g_test.operations || !popNext())
+                break;
+        }
+    }
+}
+
+static void setTimer(long period_us)
+{
+    struct itimerval timer = {{0, period_us}, {0, period_us}};
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+static void runInterrupts(void)
+{
+    struct sigaction action = {0};
+    action.sa_handler = interruptHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    setTimer(INTERRUPT_PERIOD_US);
+
+    // The main thread's side. It doesn't yield, since the interrupts preempt it
+    if (g_test.mode == INTERRUPT_PRODUCER)
+    {
+        while (g_test.popped != g_test.operations)
+        {
+            popNext();
+            doMainLoopWork();
+        }
+    }
+    else
+    {
+        while (g_test.pushed != g_test.operations)
+        {
+            pushNext();
+            doMainLoopWork();
+        }
+    }
+
+    setTimer(0);
+}
+
+static void runThreads(void)
+{
+    pthread_t producer;
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, consume, NULL);
+    pthread_create(&producer, NULL, produce, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+}
+
+static bool run(const char* name, queue_id_t queue, stress_mode_t mode, unsigned long operations)
+{
+    spscQueue_initialize(&g_tiny_queue);
+    spscQueue_initialize(&g_queue);
+    pairQueue_initialize(&g_pair_queue);
+
+    g_test = (__typeof__(g_test)){.queue = queue, .mode = mode, .operations = operations};
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (mode == THREADS)
+        runThreads();
+    else
+        runInterrupts();
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%-24s %-18s %8.2f Mops/s %10lu full %10lu empty %9lu interrupts %6lu failures\n", name,
+           g_mode_names[mode], operations / seconds / 1e6, g_test.full_pushes, g_test.empty_pops, g_test.interrupts,
+           g_test.failures);
+
+    if (g_test.failures != 0)
+    {
+        printf("  first failure at pop %lu: expected %u, got %u%s\n", g_test.first_failure_index,
+               g_test.first_failure_expected, g_test.first_failure_value, g_test.first_failure_torn ? ", torn" : "");
+    }
+
+    return g_test.failures == 0;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long operations = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_OPERATIONS;
+
+#if !defined(__x86_64__) && !defined(__i386__)
+    printf("Warning: this host may reorder memory accesses between cores, so failures in the thread mode may not apply "
+           "to the PIC\n");
+#endif
+
+    bool passed = true;
+    for (stress_mode_t mode = THREADS; mode <= INTERRUPT_CONSUMER; mode++)
+    {
+        unsigned long mode_operations = mode == THREADS ? operations : operations / INTERRUPT_OPERATIONS_DIVISOR;
+        passed &= run("SpscQueue, length 2", TINY_QUEUE, mode, mode_operations);
+        passed &= run("SpscQueue, length 64", QUEUE, mode, mode_operations);
+        passed &= run("typed queue of pairs, 16", PAIR_QUEUE, mode, mode_operations);
+    }
+
+    printf(passed ? "passed\n" : "FAILED\n");
+    return passed ? 0 : 1;
+}
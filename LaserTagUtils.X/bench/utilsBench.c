@@ -0,0 +1,294 @@
+// Benchmarks of the byte queues, string queues and bit arrays
+
+#include "bench.h"
+
+#include "../bitArray.h"
+#include "../circularBuffer.h"
+#include "../framedStringQueue.h"
+#include "../keyedLaneQueue.h"
+#include "../queue.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The same sizes as the I2C and pulse width queues on the targets
+#define QUEUE_LENGTH 64
+#define STRING_QUEUE_LENGTH 128
+
+// Bytes to push, and somewhere to pop them to
+static uint8_t g_data[STRING_QUEUE_LENGTH];
+static uint8_t g_data_out[STRING_QUEUE_LENGTH];
+
+static uint8_t g_queue_storage[QUEUE_LENGTH];
+static queue_t g_queue;
+
+static uint8_t g_string_queue_storage[STRING_QUEUE_LENGTH];
+static framed_string_queue_t g_framed_queue;
+
+// Start the byte queue empty, with its indices part way round so that operations wrap
+static void setupQueue(void)
+{
+    g_queue = queue_create(g_queue_storage, QUEUE_LENGTH);
+    for (uint8_t i = 0; i < QUEUE_LENGTH / 2 + 5; i++)
+    {
+        uint8_t byte;
+        queue_push(&g_queue, i);
+        queue_pop(&g_queue, &byte);
+    }
+}
+
+static void runQueuePushPop(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t byte = 0;
+        queue_push(&g_queue, (uint8_t)i);
+        queue_pop(&g_queue, &byte);
+        g_bench_sink = byte;
+    }
+}
+
+static void runQueueSpans(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        queue_pushSpan(&g_queue, g_data, 16);
+        g_bench_sink = queue_popSpan(&g_queue, 16, g_data_out);
+    }
+}
+
+// Half fill the buffer, so that reads wrap around the end of its storage
+static void setupHalfFullQueue(void)
+{
+    setupQueue();
+    for (uint8_t i = 0; i < QUEUE_LENGTH / 2; i++)
+        queue_push(&g_queue, i);
+}
+
+static void runCircularBufferGet(uint32_t count)
+{
+    uint8_t size = circularBuffer_size(&g_queue);
+    uint8_t index = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        g_bench_sink = circularBuffer_get(&g_queue, index);
+        index++;
+        if (index == size)
+            index = 0;
+    }
+}
+
+// Start the framed queue empty, with its indices part way round so that strings wrap
+static void setupFramedQueue(void)
+{
+    g_framed_queue = framedStringQueue_create(g_string_queue_storage, STRING_QUEUE_LENGTH);
+    for (uint8_t i = 0; i < sizeof(g_data); i++)
+        g_data[i] = i;
+
+    uint8_t length;
+    framedStringQueue_push(&g_framed_queue, g_data, 50);
+    framedStringQueue_pop(&g_framed_queue, 50, g_data_out, &length);
+}
+
+static void runFramedPushPop(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t length;
+        framedStringQueue_push(&g_framed_queue, g_data, 8);
+        g_bench_sink = framedStringQueue_pop(&g_framed_queue, 8, g_data_out, &length);
+    }
+}
+
+// The way the I2C drivers push a message, a few bytes at a time as they're written
+static void runFramedPartials(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t length;
+        framedStringQueue_pushPartial(&g_framed_queue, g_data, 3, false);
+        framedStringQueue_pushPartial(&g_framed_queue, g_data + 3, 3, false);
+        framedStringQueue_pushPartial(&g_framed_queue, g_data + 6, 2, true);
+        framedStringQueue_pop(&g_framed_queue, 4, g_data_out, &length);
+        g_bench_sink = framedStringQueue_pop(&g_framed_queue, 4, g_data_out, &length);
+    }
+}
+
+// The way the I2C master sends a message, reading it a byte at a time in place and releasing it once it's sent
+static void runFramedReserveSend(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        circular_buffer_span_t span;
+        framedStringQueue_reserve(&g_framed_queue, 8, &span);
+        for (uint8_t j = 0; j < 8; j++)
+            circularBuffer_spanSet(&span, j, g_data[j]);
+        framedStringQueue_commit(&g_framed_queue, 8);
+
+        uint8_t length = framedStringQueue_peek(&g_framed_queue, &span);
+        for (uint8_t j = 0; j < length; j++)
+            g_bench_sink = circularBuffer_spanGet(&span, j);
+        framedStringQueue_release(&g_framed_queue);
+    }
+}
+
+// On every I2C event handler call
+static void runFramedHasFullString(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        g_bench_sink = framedStringQueue_hasFullString(&g_framed_queue);
+}
+
+// Keyed pops. The queue holds strings of three bytes for one key, as many as fill it to the given fraction, as LED
+// driver writes would queue alongside the transceiver's reads. An operation pushes a string for another key and pops it
+// again, which shouldn't depend on how full the queue is
+#define KEYED_STRING_LENGTH 3
+#define KEYED_OTHER_KEY 1
+#define KEYED_KEY 2
+
+static keyed_lane_queue_t g_keyed_queue;
+
+static void fillKeyedQueue(uint8_t percent)
+{
+    g_keyed_queue = keyedLaneQueue_create(g_string_queue_storage, STRING_QUEUE_LENGTH);
+    uint8_t string_count = keyedLaneQueue_freeCapacity(&g_keyed_queue) * percent / 100 / KEYED_STRING_LENGTH;
+    for (uint8_t i = 0; i < string_count; i++)
+        keyedLaneQueue_push(&g_keyed_queue, KEYED_OTHER_KEY, g_data, KEYED_STRING_LENGTH);
+}
+
+static void setupKeyed25(void)
+{
+    fillKeyedQueue(25);
+}
+
+static void setupKeyed50(void)
+{
+    fillKeyedQueue(50);
+}
+
+static void setupKeyed75(void)
+{
+    fillKeyedQueue(75);
+}
+
+static void runKeyedPushPop(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t length;
+        keyedLaneQueue_push(&g_keyed_queue, KEYED_KEY, g_data, KEYED_STRING_LENGTH);
+        g_bench_sink = keyedLaneQueue_pop(&g_keyed_queue, KEYED_KEY, KEYED_STRING_LENGTH, g_data_out, &length);
+    }
+}
+
+// Bit arrays, of the largest size the 8-bit index functions allow
+#define BIT_ARRAY_BYTES 32
+
+static uint8_t g_bits[BIT_ARRAY_BYTES + 1];
+static uint8_t g_bits_out[BIT_ARRAY_BYTES + 1];
+
+static void setupBits(void)
+{
+    for (uint8_t i = 0; i < sizeof(g_bits); i++)
+    {
+        g_bits[i] = (uint8_t)(i * 37 + 11);
+        g_bits_out[i] = 0;
+    }
+}
+
+// The all-clear array is the worst case for findFirstSet, which searches all of it
+static void setupClearBits(void)
+{
+    for (uint8_t i = 0; i < sizeof(g_bits); i++)
+        g_bits[i] = 0;
+}
+
+static void runGetBit(uint32_t count)
+{
+    uint8_t index = 0;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sum += bitArray_getBit(g_bits, index);
+        index++;
+    }
+    g_bench_sink = sum;
+}
+
+static void runSetBit(uint32_t count)
+{
+    uint8_t index = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bitArray_setBit(g_bits_out, index, (i & 2) != 0);
+        index++;
+    }
+    g_bench_sink = g_bits_out[3];
+}
+
+// Unaligned, so that each byte spans two bytes of the array
+static void runGetByte(uint32_t count)
+{
+    uint8_t index = 3;
+    uint8_t sum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sum += bitArray_getByte(g_bits, index);
+        index = index < 240 ? index + 8 : 3;
+    }
+    g_bench_sink = sum;
+}
+
+static void runSetByte(uint32_t count)
+{
+    uint8_t index = 3;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bitArray_setByte(g_bits_out, index, (uint8_t)i);
+        index = index < 240 ? index + 8 : 3;
+    }
+    g_bench_sink = g_bits_out[3];
+}
+
+// As the transceiver copies the bits of a transmission, at offsets that don't line up
+static void runCopyBits(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        bitArray_copyBits(g_bits_out, 5, g_bits, 3, 40);
+    g_bench_sink = g_bits_out[2];
+}
+
+static void runFindFirstSet(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        g_bench_sink = bitArray_findFirstSet(g_bits, 1, 255);
+}
+
+static void runCountSet(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        g_bench_sink = bitArray_countSet(g_bits, 1, 255);
+}
+
+static const benchmark_t g_benchmarks[] = {
+    {"queue_push and queue_pop", "byte", setupQueue, runQueuePushPop},
+    {"queue_pushSpan and queue_popSpan, 16 bytes", "span", setupQueue, runQueueSpans},
+    {"circularBuffer_get, wrapped", "byte", setupHalfFullQueue, runCircularBufferGet},
+    {"framedStringQueue_push and framedStringQueue_pop, 8 bytes", "string", setupFramedQueue, runFramedPushPop},
+    {"framedStringQueue partials, pushed 3+3+2 and popped 4+4", "string", setupFramedQueue, runFramedPartials},
+    {"framedStringQueue reserved and sent in place, 8 bytes", "string", setupFramedQueue, runFramedReserveSend},
+    {"framedStringQueue_hasFullString", "call", setupFramedQueue, runFramedHasFullString},
+    {"keyedLaneQueue push and pop, 25% full of another key", "string", setupKeyed25, runKeyedPushPop},
+    {"keyedLaneQueue push and pop, 50% full of another key", "string", setupKeyed50, runKeyedPushPop},
+    {"keyedLaneQueue push and pop, 75% full of another key", "string", setupKeyed75, runKeyedPushPop},
+    {"bitArray_getBit", "bit", setupBits, runGetBit},
+    {"bitArray_setBit", "bit", setupBits, runSetBit},
+    {"bitArray_getByte, unaligned", "byte", setupBits, runGetByte},
+    {"bitArray_setByte, unaligned", "byte", setupBits, runSetByte},
+    {"bitArray_copyBits, 40 bits, unaligned", "copy", setupBits, runCopyBits},
+    {"bitArray_findFirstSet, 254 clear bits", "call", setupClearBits, runFindFirstSet},
+    {"bitArray_countSet, 254 bits", "call", setupBits, runCountSet},
+    {0},
+};
+
+const benchmark_group_t g_utils_benchmarks = {"Queues, string queues and bit arrays", g_benchmarks};
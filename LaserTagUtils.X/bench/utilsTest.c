@@ -0,0 +1,605 @@
+// Tests of the queues and pools that the firmware passes I2C messages through. Each is run against a simple model of what it
+// should hold, through long random sequences of operations on small storage, so that indices wrap around the end of
+// the storage many times and the queues are often full. A queue's run stops at its first failure.
+//
+// - framedStringQueue: pushes, partial pushes, reserve and commit, pops of up to a given length, and peek and release,
+//   including reserving while a partial string is open, popping the partial string while it's still being pushed, and
+//   peeking at strings that wrap around the end of the storage
+// - keyedLaneQueue: pushes, partial pushes and pops of up to a given length across more keys than there are lanes, in a
+//   pool small enough that lanes chain through every block and pushes are refused for want of a block or a lane
+// - framePool: allocating until the pool is exhausted and freeing in random order, checking that no frame is handed out
+//   twice and that frames don't overlap, and pools sized from storage that's too short, not a multiple of a frame or
+//   long enough for more than FRAME_POOL_MAX_FRAME_COUNT frames
+//
+// Usage: utilsTest. Exits with a non-zero status if any check fails
+
+#include "../framePool.h"
+#include "../framedStringQueue.h"
+#include "../keyedLaneQueue.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Random operations run on each queue
+#define OPERATIONS 200000UL
+// The most failures printed. Only the count of the rest is
+#define MAX_PRINTED_FAILURES 10
+
+static unsigned long g_failures;
+// What's being tested, and the operation it's on, for failure messages
+static const char* g_test;
+static unsigned long g_operation;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool passed, const char* condition, int line)
+{
+    if (passed)
+        return;
+
+    if (g_failures < MAX_PRINTED_FAILURES)
+        printf("FAILED %s, operation %lu, line %d: %s\n", g_test, g_operation, line, condition);
+    g_failures++;
+}
+
+static uint8_t randomByte(void)
+{
+    return (uint8_t)rand();
+}
+
+// Random lengths, mostly short, so that many strings fit in the queue, but some long enough to fill it
+static uint8_t randomLength(uint8_t max)
+{
+    uint8_t length = randomByte() % 8 == 0 ? randomByte() : randomByte() % 6;
+    return length % (max + 1);
+}
+
+// -- framedStringQueue --
+
+// Storage of 17 bytes, so that the header and the bytes of a string wrap at every offset, and of 16, a power of two, so
+// that the buffer wraps its indices with a mask
+#define FRAMED_MAX_STORAGE_LENGTH 17
+#define FRAMED_MAX_CAPACITY (FRAMED_MAX_STORAGE_LENGTH - 1)
+
+static uint8_t g_framed_capacity;
+
+// The strings that should be in the queue, front first. Only the last can be partial, i.e. still being pushed. A string
+// of the model holds the bytes of it that are still in the queue
+typedef struct
+{
+    uint8_t bytes[FRAMED_MAX_CAPACITY];
+    uint8_t length;
+    bool is_complete;
+} model_string_t;
+
+static model_string_t g_model[FRAMED_MAX_CAPACITY];
+static uint8_t g_model_count;
+
+static bool modelHasPartial(void)
+{
+    return g_model_count != 0 && !g_model[g_model_count - 1].is_complete;
+}
+
+static uint8_t modelSize(void)
+{
+    // Every string in the queue has a header
+    uint8_t size = 0;
+    for (uint8_t i = 0; i < g_model_count; i++)
+        size += g_model[i].length + 1;
+    return size;
+}
+
+static uint8_t modelFullStringCount(void)
+{
+    return modelHasPartial() ? g_model_count - 1 : g_model_count;
+}
+
+static void modelAppend(uint8_t* bytes, uint8_t length, bool is_end_of_string)
+{
+    if (!modelHasPartial())
+    {
+        g_model[g_model_count] = (model_string_t){.length = 0, .is_complete = false};
+        g_model_count++;
+    }
+
+    model_string_t* string = &g_model[g_model_count - 1];
+    for (uint8_t i = 0; i < length; i++)
+        string->bytes[string->length++] = bytes[i];
+    string->is_complete = is_end_of_string;
+}
+
+static void modelPopFront(uint8_t length)
+{
+    model_string_t* front = &g_model[0];
+    if (front->is_complete && length == front->length)
+    {
+        for (uint8_t i = 1; i < g_model_count; i++)
+            g_model[i - 1] = g_model[i];
+        g_model_count--;
+        return;
+    }
+
+    for (uint8_t i = length; i < front->length; i++)
+        front->bytes[i - length] = front->bytes[i];
+    front->length -= length;
+}
+
+static void testFramedPushPartial(framed_string_queue_t* queue)
+{
+    uint8_t bytes[FRAMED_MAX_CAPACITY + 1];
+    uint8_t length = randomLength(g_framed_capacity + 1);
+    bool is_end_of_string = randomByte() % 3 != 0;
+    for (uint8_t i = 0; i < length; i++)
+        bytes[i] = randomByte();
+
+    // A new string needs room for its header too. Nothing is pushed for an empty part, except that it can complete an
+    // open string
+    uint8_t required = modelHasPartial() ? length : length + 1;
+    bool should_push = length == 0 || required <= g_framed_capacity - modelSize();
+
+    bool pushed = framedStringQueue_pushPartial(queue, bytes, length, is_end_of_string);
+    CHECK(pushed == should_push);
+    if (pushed && (length != 0 || modelHasPartial()))
+        modelAppend(bytes, length, is_end_of_string);
+}
+
+static void testFramedReserve(framed_string_queue_t* queue)
+{
+    uint8_t length = randomLength(g_framed_capacity);
+    bool should_reserve = !modelHasPartial() && length + 1 <= g_framed_capacity - modelSize();
+
+    circular_buffer_span_t span;
+    bool reserved = framedStringQueue_reserve(queue, length, &span);
+    CHECK(reserved == should_reserve);
+    if (!reserved)
+        return;
+
+    CHECK(span.first_length + span.second_length == length);
+
+    // Nothing reserved is in the queue until it's committed
+    uint8_t bytes[FRAMED_MAX_CAPACITY];
+    for (uint8_t i = 0; i < length; i++)
+    {
+        bytes[i] = randomByte();
+        circularBuffer_spanSet(&span, i, bytes[i]);
+    }
+    CHECK(framedStringQueue_size(queue) == modelSize());
+    CHECK(framedStringQueue_hasFullString(queue) == (modelFullStringCount() != 0));
+
+    framedStringQueue_commit(queue, length);
+    modelAppend(bytes, length, true);
+}
+
+static void testFramedPop(framed_string_queue_t* queue)
+{
+    uint8_t max_length = randomLength(g_framed_capacity);
+    uint8_t bytes[FRAMED_MAX_CAPACITY];
+    uint8_t length = 0xFF;
+    bool is_end_of_string = framedStringQueue_pop(queue, max_length, bytes, &length);
+
+    if (g_model_count == 0)
+    {
+        CHECK(!is_end_of_string && length == 0);
+        return;
+    }
+
+    model_string_t* front = &g_model[0];
+    uint8_t expected_length = front->length < max_length ? front->length : max_length;
+    CHECK(length == expected_length);
+    CHECK(is_end_of_string == (front->is_complete && length == front->length));
+    for (uint8_t i = 0; i < length && i < expected_length; i++)
+        CHECK(bytes[i] == front->bytes[i]);
+
+    modelPopFront(expected_length);
+}
+
+static void testFramedPeekRelease(framed_string_queue_t* queue)
+{
+    circular_buffer_span_t span;
+    uint8_t length = framedStringQueue_peek(queue, &span);
+    if (modelFullStringCount() == 0)
+    {
+        CHECK(length == 0);
+        return;
+    }
+
+    model_string_t* front = &g_model[0];
+    CHECK(length == front->length);
+    CHECK(framedStringQueue_peekStringLength(queue) == front->length);
+    CHECK(span.first_length + span.second_length == length);
+    for (uint8_t i = 0; i < length && i < front->length; i++)
+        CHECK(circularBuffer_spanGet(&span, i) == front->bytes[i]);
+
+    // Release only some of the time, so that peeks also see strings that pops have partly taken
+    if (randomByte() % 2 == 0)
+    {
+        framedStringQueue_release(queue);
+        modelPopFront(front->length);
+    }
+}
+
+static void testFramedStringQueue(uint8_t storage_length)
+{
+    static uint8_t storage[FRAMED_MAX_STORAGE_LENGTH];
+    framed_string_queue_t queue = framedStringQueue_create(storage, storage_length);
+    g_framed_capacity = storage_length - 1;
+    g_model_count = 0;
+
+    CHECK(framedStringQueue_capacity(&queue) == g_framed_capacity);
+
+    for (g_operation = 0; g_operation < OPERATIONS; g_operation++)
+    {
+        switch (randomByte() % 4)
+        {
+            case 0:
+                testFramedPushPartial(&queue);
+                break;
+            case 1:
+                testFramedReserve(&queue);
+                break;
+            case 2:
+                testFramedPop(&queue);
+                break;
+            default:
+                testFramedPeekRelease(&queue);
+                break;
+        }
+
+        CHECK(framedStringQueue_size(&queue) == modelSize());
+        CHECK(framedStringQueue_freeCapacity(&queue) == g_framed_capacity - modelSize());
+        CHECK(framedStringQueue_hasFullString(&queue) == (modelFullStringCount() != 0));
+
+        // Once the queue and the model disagree, later operations only show the same failure
+        if (g_failures != 0)
+            break;
+    }
+}
+
+// -- keyedLaneQueue --
+
+// Storage for 5 blocks, with 4 bytes left over
+#define KEYED_STORAGE_LENGTH (5 * (KEYED_LANE_QUEUE_BLOCK_SIZE + 2) + 4)
+#define KEYED_BLOCK_COUNT 5
+// More keys than lanes, so that pushes for a new key are sometimes refused for want of a lane
+#define KEYED_KEY_COUNT (KEYED_LANE_QUEUE_LANE_COUNT + 2)
+#define KEYED_MAX_LANE_LENGTH (KEYED_BLOCK_COUNT * KEYED_LANE_QUEUE_BLOCK_SIZE)
+
+// The bytes that should be in each key's lane, front first, and whether each ends a string. A key with no bytes has no
+// lane. head_offset is the offset of the first byte in the lane's first block, which with the number of bytes gives
+// the number of blocks the lane holds
+typedef struct
+{
+    uint8_t bytes[KEYED_MAX_LANE_LENGTH];
+    bool is_end[KEYED_MAX_LANE_LENGTH];
+    uint8_t length;
+    uint8_t head_offset;
+} model_lane_t;
+
+static model_lane_t g_lanes[KEYED_KEY_COUNT];
+
+static uint8_t laneBlockCount(uint8_t key)
+{
+    model_lane_t* lane = &g_lanes[key];
+    uint8_t end = lane->head_offset + lane->length;
+    return (end + KEYED_LANE_QUEUE_BLOCK_SIZE - 1) / KEYED_LANE_QUEUE_BLOCK_SIZE;
+}
+
+static uint8_t modelFreeBlockCount(void)
+{
+    uint8_t used = 0;
+    for (uint8_t key = 0; key < KEYED_KEY_COUNT; key++)
+        used += laneBlockCount(key);
+    return KEYED_BLOCK_COUNT - used;
+}
+
+static uint8_t modelLaneCount(void)
+{
+    uint8_t count = 0;
+    for (uint8_t key = 0; key < KEYED_KEY_COUNT; key++)
+    {
+        if (g_lanes[key].length != 0)
+            count++;
+    }
+    return count;
+}
+
+static bool modelHasFullString(uint8_t key)
+{
+    for (uint8_t i = 0; i < g_lanes[key].length; i++)
+    {
+        if (g_lanes[key].is_end[i])
+            return true;
+    }
+    return false;
+}
+
+static void testKeyedPushPartial(keyed_lane_queue_t* queue, uint8_t key)
+{
+    model_lane_t* lane = &g_lanes[key];
+
+    uint8_t bytes[KEYED_MAX_LANE_LENGTH + 1];
+    uint8_t length = randomLength(KEYED_MAX_LANE_LENGTH + 1);
+    bool is_end_of_string = randomByte() % 3 != 0;
+    for (uint8_t i = 0; i < length; i++)
+        bytes[i] = randomByte();
+
+    // A new lane needs an unused lane and enough free blocks. An existing one can also fill the rest of its last block
+    bool should_push;
+    uint8_t free_bytes = modelFreeBlockCount() * KEYED_LANE_QUEUE_BLOCK_SIZE;
+    if (lane->length == 0)
+    {
+        should_push = length == 0
+                      || (free_bytes >= length && modelLaneCount() < KEYED_LANE_QUEUE_LANE_COUNT);
+    }
+    else
+    {
+        uint8_t tail_block_free = laneBlockCount(key) * KEYED_LANE_QUEUE_BLOCK_SIZE - lane->head_offset - lane->length;
+        should_push = free_bytes + tail_block_free >= length;
+    }
+
+    bool pushed = keyedLaneQueue_pushPartial(queue, key, bytes, length, is_end_of_string);
+    CHECK(pushed == should_push);
+    if (!pushed)
+        return;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        lane->bytes[lane->length] = bytes[i];
+        lane->is_end[lane->length] = false;
+        lane->length++;
+    }
+    if (is_end_of_string && lane->length != 0)
+        lane->is_end[lane->length - 1] = true;
+}
+
+static void testKeyedPop(keyed_lane_queue_t* queue, uint8_t key)
+{
+    model_lane_t* lane = &g_lanes[key];
+
+    uint8_t max_length = randomLength(KEYED_MAX_LANE_LENGTH);
+    uint8_t bytes[KEYED_MAX_LANE_LENGTH];
+    uint8_t length = 0xFF;
+    bool is_end_of_string = keyedLaneQueue_pop(queue, key, max_length, bytes, &length);
+
+    // Pops stop after the last byte of a string
+    uint8_t expected_length = 0;
+    bool expected_end = false;
+    while (expected_length < max_length && expected_length < lane->length && !expected_end)
+    {
+        expected_end = lane->is_end[expected_length];
+        expected_length++;
+    }
+
+    CHECK(length == expected_length);
+    CHECK(is_end_of_string == expected_end);
+    for (uint8_t i = 0; i < length && i < expected_length; i++)
+        CHECK(bytes[i] == lane->bytes[i]);
+
+    for (uint8_t i = expected_length; i < lane->length; i++)
+    {
+        lane->bytes[i - expected_length] = lane->bytes[i];
+        lane->is_end[i - expected_length] = lane->is_end[i];
+    }
+    lane->length -= expected_length;
+    lane->head_offset = lane->length == 0 ? 0 : (lane->head_offset + expected_length) % KEYED_LANE_QUEUE_BLOCK_SIZE;
+}
+
+// One lane chained through every block of the pool, which then refuses another byte for that key or any other
+static void testKeyedLaneAtCapacity(void)
+{
+    g_test = "keyedLaneQueue, one lane at capacity";
+    g_operation = 0;
+
+    static uint8_t storage[KEYED_STORAGE_LENGTH];
+    keyed_lane_queue_t queue = keyedLaneQueue_create(storage, KEYED_STORAGE_LENGTH);
+
+    uint8_t bytes[KEYED_MAX_LANE_LENGTH];
+    for (uint8_t i = 0; i < KEYED_MAX_LANE_LENGTH; i++)
+        bytes[i] = (uint8_t)(i * 7 + 1);
+
+    // Push in parts that don't line up with the blocks, ending a string part way through the third block
+    CHECK(keyedLaneQueue_pushPartial(&queue, 1, bytes, 5, false));
+    CHECK(keyedLaneQueue_pushPartial(&queue, 1, bytes + 5, 15, true));
+    CHECK(keyedLaneQueue_push(&queue, 1, bytes + 20, KEYED_MAX_LANE_LENGTH - 20));
+    CHECK(keyedLaneQueue_freeCapacity(&queue) == 0);
+    CHECK(!keyedLaneQueue_push(&queue, 1, bytes, 1));
+    CHECK(!keyedLaneQueue_push(&queue, 2, bytes, 1));
+
+    uint8_t popped[KEYED_MAX_LANE_LENGTH];
+    uint8_t length;
+    CHECK(keyedLaneQueue_pop(&queue, 1, KEYED_MAX_LANE_LENGTH, popped, &length));
+    CHECK(length == 20);
+    // The first two blocks are free again, and the lane's third block now starts part way through
+    CHECK(keyedLaneQueue_freeCapacity(&queue) == 2 * KEYED_LANE_QUEUE_BLOCK_SIZE);
+    CHECK(keyedLaneQueue_push(&queue, 2, bytes, 2 * KEYED_LANE_QUEUE_BLOCK_SIZE));
+    CHECK(keyedLaneQueue_pop(&queue, 1, KEYED_MAX_LANE_LENGTH, popped + 20, &length));
+    CHECK(length == KEYED_MAX_LANE_LENGTH - 20);
+    for (uint8_t i = 0; i < KEYED_MAX_LANE_LENGTH; i++)
+        CHECK(popped[i] == bytes[i]);
+
+    // The lane's blocks and the lane itself are released once it's empty
+    CHECK(!keyedLaneQueue_hasFullString(&queue, 1));
+    CHECK(keyedLaneQueue_freeCapacity(&queue) == (KEYED_BLOCK_COUNT - 2) * KEYED_LANE_QUEUE_BLOCK_SIZE);
+}
+
+static void testKeyedLaneQueue(void)
+{
+    g_test = "keyedLaneQueue";
+
+    static uint8_t storage[KEYED_STORAGE_LENGTH];
+    keyed_lane_queue_t queue = keyedLaneQueue_create(storage, KEYED_STORAGE_LENGTH);
+    for (uint8_t key = 0; key < KEYED_KEY_COUNT; key++)
+        g_lanes[key] = (model_lane_t){.length = 0, .head_offset = 0};
+
+    CHECK(keyedLaneQueue_freeCapacity(&queue) == KEYED_MAX_LANE_LENGTH);
+
+    for (g_operation = 0; g_operation < OPERATIONS; g_operation++)
+    {
+        uint8_t key = randomByte() % KEYED_KEY_COUNT;
+        if (randomByte() % 2 == 0)
+            testKeyedPushPartial(&queue, key);
+        else
+            testKeyedPop(&queue, key);
+
+        CHECK(keyedLaneQueue_freeCapacity(&queue) == modelFreeBlockCount() * KEYED_LANE_QUEUE_BLOCK_SIZE);
+        for (uint8_t other_key = 0; other_key < KEYED_KEY_COUNT; other_key++)
+            CHECK(keyedLaneQueue_hasFullString(&queue, other_key) == modelHasFullString(other_key));
+
+        if (g_failures != 0)
+            break;
+    }
+}
+
+// -- framePool --
+
+#define POOL_FRAME_SIZE 5
+#define POOL_FRAME_COUNT 7
+
+static bool g_allocated[POOL_FRAME_COUNT];
+static frame_handle_t g_allocated_frames[POOL_FRAME_COUNT];
+static uint8_t g_allocated_count;
+
+// Each allocated frame is filled with its handle, so that a frame handed out twice, or overlapping another, shows up as
+// a frame whose bytes have been overwritten
+static bool frameHolds(frame_pool_t* pool, frame_handle_t frame, uint8_t value)
+{
+    uint8_t* bytes = framePool_getFrame(pool, frame);
+    for (uint8_t i = 0; i < POOL_FRAME_SIZE; i++)
+    {
+        if (bytes[i] != value)
+            return false;
+    }
+    return true;
+}
+
+static void testFramePoolAllocate(frame_pool_t* pool)
+{
+    frame_handle_t frame = framePool_allocate(pool);
+    if (g_allocated_count == POOL_FRAME_COUNT)
+    {
+        CHECK(frame == FRAME_POOL_NO_FRAME);
+        return;
+    }
+
+    CHECK(frame < POOL_FRAME_COUNT);
+    if (frame >= POOL_FRAME_COUNT)
+        return;
+    CHECK(!g_allocated[frame]);
+
+    uint8_t* bytes = framePool_getFrame(pool, frame);
+    for (uint8_t i = 0; i < POOL_FRAME_SIZE; i++)
+        bytes[i] = frame;
+    g_allocated[frame] = true;
+    g_allocated_frames[g_allocated_count] = frame;
+    g_allocated_count++;
+}
+
+static void testFramePoolFree(frame_pool_t* pool)
+{
+    if (g_allocated_count == 0)
+        return;
+
+    uint8_t index = randomByte() % g_allocated_count;
+    frame_handle_t frame = g_allocated_frames[index];
+    CHECK(frameHolds(pool, frame, frame));
+
+    framePool_free(pool, frame);
+    g_allocated[frame] = false;
+    g_allocated_count--;
+    g_allocated_frames[index] = g_allocated_frames[g_allocated_count];
+}
+
+static void testFramePool(void)
+{
+    g_test = "framePool";
+
+    // A guard byte after the storage catches frames or links written past its end
+    static uint8_t storage[FRAME_POOL_STORAGE_LENGTH(POOL_FRAME_SIZE, POOL_FRAME_COUNT) + 1];
+    storage[sizeof(storage) - 1] = 0xA5;
+    frame_pool_t pool = framePool_create(storage, sizeof(storage) - 1, POOL_FRAME_SIZE);
+    for (uint8_t frame = 0; frame < POOL_FRAME_COUNT; frame++)
+        g_allocated[frame] = false;
+    g_allocated_count = 0;
+
+    CHECK(framePool_frameSize(&pool) == POOL_FRAME_SIZE);
+    CHECK(framePool_frameCount(&pool) == POOL_FRAME_COUNT);
+
+    for (g_operation = 0; g_operation < OPERATIONS; g_operation++)
+    {
+        // Lean towards allocating, so that the pool is often exhausted
+        if (randomByte() % 5 < 3)
+            testFramePoolAllocate(&pool);
+        else
+            testFramePoolFree(&pool);
+
+        CHECK(framePool_freeFrameCount(&pool) == POOL_FRAME_COUNT - g_allocated_count);
+        CHECK(storage[sizeof(storage) - 1] == 0xA5);
+
+        if (g_failures != 0)
+            break;
+    }
+
+    // Every frame still allocated holds what was written to it
+    for (uint8_t i = 0; i < g_allocated_count; i++)
+        CHECK(frameHolds(&pool, g_allocated_frames[i], g_allocated_frames[i]));
+}
+
+// Pools hold as many whole frames as fit in their storage, up to FRAME_POOL_MAX_FRAME_COUNT
+static void testFramePoolSizes(void)
+{
+    g_test = "framePool, sizes";
+    g_operation = 0;
+
+    static uint8_t storage[FRAME_POOL_STORAGE_LENGTH(3, 300)];
+
+    frame_pool_t pool = framePool_create(storage, POOL_FRAME_SIZE, POOL_FRAME_SIZE);
+    CHECK(framePool_frameCount(&pool) == 0);
+    CHECK(framePool_freeFrameCount(&pool) == 0);
+    CHECK(framePool_allocate(&pool) == FRAME_POOL_NO_FRAME);
+
+    pool = framePool_create(storage, FRAME_POOL_STORAGE_LENGTH(POOL_FRAME_SIZE, 2) + POOL_FRAME_SIZE, POOL_FRAME_SIZE);
+    CHECK(framePool_frameCount(&pool) == 2);
+    CHECK(framePool_allocate(&pool) != FRAME_POOL_NO_FRAME);
+    CHECK(framePool_allocate(&pool) != FRAME_POOL_NO_FRAME);
+    CHECK(framePool_allocate(&pool) == FRAME_POOL_NO_FRAME);
+
+    // Storage for 300 frames, of which only FRAME_POOL_MAX_FRAME_COUNT can have a handle
+    pool = framePool_create(storage, sizeof(storage), 3);
+    CHECK(framePool_frameCount(&pool) == FRAME_POOL_MAX_FRAME_COUNT);
+    uint16_t allocated = 0;
+    while (framePool_allocate(&pool) != FRAME_POOL_NO_FRAME && allocated <= FRAME_POOL_MAX_FRAME_COUNT)
+        allocated++;
+    CHECK(allocated == FRAME_POOL_MAX_FRAME_COUNT);
+    CHECK(framePool_freeFrameCount(&pool) == 0);
+
+    // A freed frame is the next one allocated
+    framePool_free(&pool, 42);
+    CHECK(framePool_freeFrameCount(&pool) == 1);
+    CHECK(framePool_allocate(&pool) == 42);
+    CHECK(framePool_allocate(&pool) == FRAME_POOL_NO_FRAME);
+}
+
+int main(void)
+{
+    srand(1);
+
+    g_test = "framedStringQueue, 17 bytes of storage";
+    testFramedStringQueue(17);
+    g_test = "framedStringQueue, 16 bytes of storage";
+    testFramedStringQueue(16);
+    testKeyedLaneAtCapacity();
+    testKeyedLaneQueue();
+    testFramePoolSizes();
+    testFramePool();
+
+    if (g_failures != 0)
+    {
+        printf("%lu failures\n", g_failures);
+        return 1;
+    }
+
+    printf("passed\n");
+    return 0;
+}
@@ -1,32 +1,123 @@
+// Compile the hot functions defined in the header
+#define BITARRAY_IMPLEMENTATION
 #include "bitArray.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 
-static inline uint8_t getByteIndex(uint8_t index)
+// PIC16 has no barrel shifter, so shifting by a variable amount compiles to a loop. Look single-bit masks up in tables
+// instead
+
+// For each bit index within a byte, the mask for that bit and all of the bits before it
+static const uint8_t g_leading_masks[8] = {0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE, 0xFF};
+// For each bit index within a byte, the mask for that bit and all of the bits after it
+static const uint8_t g_trailing_masks[8] = {0xFF, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01};
+// The number of set bits in each 4-bit value
+static const uint8_t g_nibble_set_counts[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+uint8_t bitArray_getByte(uint8_t* arr, uint8_t index)
+{
+    uint8_t byte_index = _bitArray_getByteIndex(index);
+    uint8_t bit_index = _bitArray_getBitIndex(index);
+
+    if (bit_index == 0)
+        return arr[byte_index];
+
+    // The variable shifts here are once per byte rather than once per bit
+    return (uint8_t)(arr[byte_index] << bit_index) | (arr[byte_index + 1] >> (8 - bit_index));
+}
+
+void bitArray_setByte(uint8_t* arr, uint8_t index, uint8_t value)
 {
-    // Bytes are in little endian order, e.g. index 0 is byte 0, index 8 is byte 1, etc
-    // `>> 3` is equivalent to `/ 8`, but ~40x faster. xc8 doesn't optimize power-of-two division.
-    return index >> 3;
+    uint8_t byte_index = _bitArray_getByteIndex(index);
+    uint8_t bit_index = _bitArray_getBitIndex(index);
+
+    if (bit_index == 0)
+    {
+        arr[byte_index] = value;
+        return;
+    }
+
+    // The high bits of the value go in the bits at and after the index in the first byte, and the low bits go in the
+    // bits before the index in the second byte
+    uint8_t mask = g_trailing_masks[bit_index];
+    arr[byte_index] = (arr[byte_index] & ~mask) | (value >> bit_index);
+    arr[byte_index + 1] = (arr[byte_index + 1] & mask) | (uint8_t)(value << (8 - bit_index));
 }
 
-static inline uint8_t getBitIndex(uint8_t index)
+void bitArray_copyBits(uint8_t* dest, uint8_t dest_index, uint8_t* src, uint8_t src_index, uint8_t count)
 {
-    // Bits are in big endian order, e.g. index 0 is bit 7, index 1 is bit 6, etc
-    // `& 0b111` is equivalent to `% 8`, but ~100x faster. xc8 *does* optimize power-of-two modulo, but writing out
-    // the optimized form just in case.
-    return 7 - (index & 0b111);
+    while (count >= 8)
+    {
+        bitArray_setByte(dest, dest_index, bitArray_getByte(src, src_index));
+        dest_index += 8;
+        src_index += 8;
+        count -= 8;
+    }
+
+    // Fewer than eight bits remain, which may not span two bytes in either array
+    while (count != 0)
+    {
+        bitArray_setBit(dest, dest_index, bitArray_getBit(src, src_index));
+        dest_index++;
+        src_index++;
+        count--;
+    }
 }
 
-bool bitArray_getBit(uint8_t* arr, uint8_t index)
+// Returns the byte of the array at the given byte index, with any bits outside of the given bit range cleared
+static uint8_t getMaskedByte(uint8_t* arr, uint8_t byte_index, uint8_t start_index, uint8_t end_index)
 {
-    return (arr[getByteIndex(index)] & (1 << getBitIndex(index))) != 0;
+    uint8_t byte = arr[byte_index];
+
+    if (byte_index == _bitArray_getByteIndex(start_index))
+        byte &= g_trailing_masks[_bitArray_getBitIndex(start_index)];
+    if (byte_index == _bitArray_getByteIndex(end_index - 1))
+        byte &= g_leading_masks[_bitArray_getBitIndex(end_index - 1)];
+
+    return byte;
 }
 
-void bitArray_setBit(uint8_t* arr, uint8_t index, bool b)
+uint8_t bitArray_findFirstSet(uint8_t* arr, uint8_t start_index, uint8_t end_index)
 {
-    if (b)
-        arr[getByteIndex(index)] |= (1 << getBitIndex(index));
-    else
-        arr[getByteIndex(index)] &= ~(1 << getBitIndex(index));
+    if (start_index >= end_index)
+        return end_index;
+
+    uint8_t last_byte_index = _bitArray_getByteIndex(end_index - 1);
+
+    for (uint8_t byte_index = _bitArray_getByteIndex(start_index); byte_index <= last_byte_index; byte_index++)
+    {
+        uint8_t byte = getMaskedByte(arr, byte_index, start_index, end_index);
+        if (byte == 0)
+            continue;
+
+        // Shift by one at a time to find the set bit, since shifting by a constant is cheap
+        uint8_t index = byte_index << 3;
+        while ((byte & 0x80) == 0)
+        {
+            byte <<= 1;
+            index++;
+        }
+
+        return index;
+    }
+
+    return end_index;
+}
+
+uint8_t bitArray_countSet(uint8_t* arr, uint8_t start_index, uint8_t end_index)
+{
+    if (start_index >= end_index)
+        return 0;
+
+    uint8_t count = 0;
+    uint8_t last_byte_index = _bitArray_getByteIndex(end_index - 1);
+
+    for (uint8_t byte_index = _bitArray_getByteIndex(start_index); byte_index <= last_byte_index; byte_index++)
+    {
+        uint8_t byte = getMaskedByte(arr, byte_index, start_index, end_index);
+        count += g_nibble_set_counts[byte >> 4] + g_nibble_set_counts[byte & 0x0F];
+    }
+
+    return count;
 }
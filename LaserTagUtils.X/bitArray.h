@@ -1,6 +1,8 @@
 #ifndef BITARRAY_H
 #define BITARRAY_H
 
+#include "utilsInline.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -8,10 +10,68 @@
 // index 0 is the most significant bit in byte zero.
 // These functions do no bounds checking. The given index must be less than or equal to eight times the length of the
 // given array.
-bool bitArray_getBit(uint8_t* arr, uint8_t index);
-void bitArray_setBit(uint8_t* arr, uint8_t index, bool b);
+UTILS_INLINE bool bitArray_getBit(uint8_t* arr, uint8_t index);
+UTILS_INLINE void bitArray_setBit(uint8_t* arr, uint8_t index, bool b);
+
+// Bulk operations. These work a byte at a time where they can, so prefer them to looping over getBit and setBit. Ranges
+// are given as an inclusive start index and an exclusive end index, and, as above, are not bounds checked.
+
+// Get the eight bits starting at the given index as a byte, with the bit at the given index as the most significant
+// bit. If the index is not a multiple of eight, the eight bits span two bytes, both of which must be in the array
+uint8_t bitArray_getByte(uint8_t* arr, uint8_t index);
+// Set the eight bits starting at the given index from a byte, with the bit at the given index taken from the most
+// significant bit. If the index is not a multiple of eight, the eight bits span two bytes, both of which must be in the
+// array
+void bitArray_setByte(uint8_t* arr, uint8_t index, uint8_t value);
+// Copy the given number of bits from one array and index to another. The source and destination ranges must not overlap
+void bitArray_copyBits(uint8_t* dest, uint8_t dest_index, uint8_t* src, uint8_t src_index, uint8_t count);
+// Returns the index of the first set bit in the given range, or end_index if none of the bits in the range are set
+uint8_t bitArray_findFirstSet(uint8_t* arr, uint8_t start_index, uint8_t end_index);
+// Returns the number of set bits in the given range
+uint8_t bitArray_countSet(uint8_t* arr, uint8_t start_index, uint8_t end_index);
 
 // The minimum number of bytes necessary to store the given number of bits
 #define NUM_BYTES(num_bits) (((num_bits) + 7) >> 3)
 
+// -- Hot functions. See utilsInline.h --
+
+#if defined(UTILS_STATIC_INLINE) || defined(BITARRAY_IMPLEMENTATION)
+
+// PIC16 has no barrel shifter, so shifting by a variable amount compiles to a loop. Look single-bit masks up in a table
+// instead
+
+// The mask for each bit index within a byte
+static const uint8_t g_bitArray_bit_masks[8] = {0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+
+static inline uint8_t _bitArray_getByteIndex(uint8_t index)
+{
+    // Bytes are in little endian order, e.g. index 0 is byte 0, index 8 is byte 1, etc
+    // `>> 3` is equivalent to `/ 8`, but ~40x faster. xc8 doesn't optimize power-of-two division.
+    return index >> 3;
+}
+
+static inline uint8_t _bitArray_getBitIndex(uint8_t index)
+{
+    // Bits are in big endian order, e.g. index 0 is the most significant bit. The mask tables are in the same order,
+    // so this is the index into them.
+    // `& 0b111` is equivalent to `% 8`, but ~100x faster. xc8 *does* optimize power-of-two modulo, but writing out
+    // the optimized form just in case.
+    return index & 0b111;
+}
+
+UTILS_INLINE bool bitArray_getBit(uint8_t* arr, uint8_t index)
+{
+    return (arr[_bitArray_getByteIndex(index)] & g_bitArray_bit_masks[_bitArray_getBitIndex(index)]) != 0;
+}
+
+UTILS_INLINE void bitArray_setBit(uint8_t* arr, uint8_t index, bool b)
+{
+    if (b)
+        arr[_bitArray_getByteIndex(index)] |= g_bitArray_bit_masks[_bitArray_getBitIndex(index)];
+    else
+        arr[_bitArray_getByteIndex(index)] &= ~g_bitArray_bit_masks[_bitArray_getBitIndex(index)];
+}
+
+#endif
+
 #endif /* BITARRAY_H */
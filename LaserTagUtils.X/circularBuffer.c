@@ -1,136 +1,198 @@
+// Compile the hot functions defined in the header
+#define CIRCULARBUFFER_IMPLEMENTATION
 #include "circularBuffer.h"
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>  // for memcpy
 
 circular_buffer_t circularBuffer_create(uint8_t* storage, uint8_t length)
 {
     circular_buffer_t circularBuffer = {
-        .storage = storage, .length = length, .front_index = 0, .back_index = 0,
+        .storage = storage, .length = length, .mask = 0, .front_index = 0, .back_index = 0,
     };
 
+    if (length >= 2 && (length & (length - 1)) == 0)
+        circularBuffer.mask = length - 1;
+
+#ifdef UTILS_QUEUE_STATS
+    queueStats_reset(&circularBuffer.stats);
+#endif
+
     return circularBuffer;
 }
 
-static uint8_t increment(uint8_t index, uint8_t end)
+bool circularBuffer_pushFront(circular_buffer_t* buffer, uint8_t data)
 {
-    // Increment our local copy
-    index++;
+    if (_circularBuffer_isFull(buffer))
+        return false;
 
-    // Wrap around to zero if we're at the end
-    if (index == end)
-        return 0;
+    buffer->front_index = _circularBuffer_decrement(buffer, buffer->front_index);
+    buffer->storage[buffer->front_index] = data;
 
-    return index;
+    return true;
 }
 
-static uint8_t decrement(uint8_t index, uint8_t end)
+bool circularBuffer_popBack(circular_buffer_t* buffer, uint8_t* data_out)
 {
-    if (index == 0)
-        return end - 1;
-    else
-        return index - 1;
-}
+    if (_circularBuffer_isEmpty(buffer))
+        return false;
 
-static bool isEmpty(circular_buffer_t* buffer)
-{
-    return buffer->back_index == buffer->front_index;
-}
+    buffer->back_index = _circularBuffer_decrement(buffer, buffer->back_index);
+    *data_out = buffer->storage[buffer->back_index];
 
-static bool isFull(circular_buffer_t* buffer)
-{
-    return buffer->back_index == decrement(buffer->front_index, buffer->length);
+    return true;
 }
 
-bool circularBuffer_pushFront(circular_buffer_t* buffer, uint8_t data)
+// Get the span of the given number of bytes starting at the given physical index
+static void getSpan(circular_buffer_t* buffer, uint8_t physical_index, uint8_t length, circular_buffer_span_t* span_out)
 {
-    if (isFull(buffer))
-        return false;
+    // Number of bytes before we need to wrap around to the start of the backing array
+    uint8_t length_before_end = buffer->length - physical_index;
 
-    buffer->front_index = decrement(buffer->front_index, buffer->length);
-    buffer->storage[buffer->front_index] = data;
+    span_out->first = buffer->storage + physical_index;
+    span_out->second = buffer->storage;
 
-    return true;
+    if (length < length_before_end)
+    {
+        span_out->first_length = length;
+        span_out->second_length = 0;
+    }
+    else
+    {
+        span_out->first_length = length_before_end;
+        span_out->second_length = length - length_before_end;
+    }
 }
 
-bool circularBuffer_pushBack(circular_buffer_t* buffer, uint8_t data)
+// Advance the given physical index by the given number of bytes, wrapping around the end of the backing array
+static uint8_t advance(circular_buffer_t* buffer, uint8_t physical_index, uint8_t length)
 {
-    if (isFull(buffer))
-        return false;
+    if (buffer->mask != 0)
+        return (uint8_t)(physical_index + length) & buffer->mask;
 
-    buffer->storage[buffer->back_index] = data;
-    buffer->back_index = increment(buffer->back_index, buffer->length);
+    uint8_t length_before_end = buffer->length - physical_index;
 
-    return true;
+    if (length < length_before_end)
+        return physical_index + length;
+    else
+        return length - length_before_end;
 }
 
-bool circularBuffer_popFront(circular_buffer_t* buffer, uint8_t* data_out)
+bool circularBuffer_reserve(circular_buffer_t* buffer, uint8_t length, circular_buffer_span_t* span_out)
 {
-    if (isEmpty(buffer))
+    if (circularBuffer_freeCapacity(buffer) < length)
+    {
+        _circularBuffer_recordFailedPush(buffer);
         return false;
+    }
 
-    *data_out = buffer->storage[buffer->front_index];
-    buffer->front_index = increment(buffer->front_index, buffer->length);
+    getSpan(buffer, buffer->back_index, length, span_out);
 
     return true;
 }
 
-bool circularBuffer_popBack(circular_buffer_t* buffer, uint8_t* data_out)
+void circularBuffer_commit(circular_buffer_t* buffer, uint8_t length)
 {
-    if (isEmpty(buffer))
-        return false;
+    // A single write of the back index publishes all of the bytes at once
+    buffer->back_index = advance(buffer, buffer->back_index, length);
+    _circularBuffer_recordPush(buffer);
+}
 
-    buffer->back_index = decrement(buffer->back_index, buffer->length);
-    *data_out = buffer->storage[buffer->back_index];
+uint8_t circularBuffer_peek(circular_buffer_t* buffer, uint8_t index, uint8_t max_length,
+                            circular_buffer_span_t* span_out)
+{
+    uint8_t size = circularBuffer_size(buffer);
+    if (index > size)
+        index = size;
 
-    return true;
+    uint8_t length = size - index;
+    if (length > max_length)
+        length = max_length;
+
+    getSpan(buffer, _circularBuffer_getPhysicalIndex(buffer, index), length, span_out);
+
+    return length;
 }
 
-uint8_t circularBuffer_get(circular_buffer_t* buffer, uint8_t index)
+void circularBuffer_release(circular_buffer_t* buffer, uint8_t length)
 {
-    return *circularBuffer_at(buffer, index);
+    // A single write of the front index frees all of the bytes at once
+    buffer->front_index = advance(buffer, buffer->front_index, length);
 }
 
-void circularBuffer_set(circular_buffer_t* buffer, uint8_t index, uint8_t value)
+uint8_t circularBuffer_spanGet(circular_buffer_span_t* span, uint8_t index)
 {
-    *circularBuffer_at(buffer, index) = value;
+    if (index < span->first_length)
+        return span->first[index];
+    else
+        return span->second[index - span->first_length];
 }
 
-uint8_t* circularBuffer_at(circular_buffer_t* buffer, uint8_t index)
+void circularBuffer_spanSet(circular_buffer_span_t* span, uint8_t index, uint8_t data)
 {
-    if (index >= circularBuffer_capacity(buffer))
-        return 0;
-
-    return buffer->storage + _circularBuffer_getPhysicalIndex(buffer, index);
+    if (index < span->first_length)
+        span->first[index] = data;
+    else
+        span->second[index - span->first_length] = data;
 }
 
-uint8_t circularBuffer_capacity(circular_buffer_t* buffer)
+void circularBuffer_spanSkip(circular_buffer_span_t* span, uint8_t count)
 {
-    return buffer->length - 1;
+    if (count < span->first_length)
+    {
+        span->first += count;
+        span->first_length -= count;
+    }
+    else
+    {
+        // The span now starts in the second segment, if anywhere
+        count -= span->first_length;
+        span->first = span->second + count;
+        span->first_length = span->second_length - count;
+        span->second_length = 0;
+    }
 }
-uint8_t circularBuffer_size(circular_buffer_t* buffer)
+
+bool circularBuffer_pushSpan(circular_buffer_t* buffer, uint8_t* data, uint8_t length)
 {
-    // The relative index of the physical back index is the size of the buffer
-    return _circularBuffer_getRelativeIndex(buffer, buffer->back_index);
+    circular_buffer_span_t span;
+    if (!circularBuffer_reserve(buffer, length, &span))
+        return false;
+
+    memcpy(span.first, data, span.first_length);
+    memcpy(span.second, data + span.first_length, span.second_length);
+
+    // Only update the back index once all of the data is in place, so that a concurrent pop never sees unwritten data
+    circularBuffer_commit(buffer, length);
+
+    return true;
 }
 
-uint8_t circularBuffer_freeCapacity(circular_buffer_t* buffer)
+uint8_t circularBuffer_popSpan(circular_buffer_t* buffer, uint8_t max_length, uint8_t* data_out)
 {
-    return circularBuffer_capacity(buffer) - circularBuffer_size(buffer);
+    circular_buffer_span_t span;
+    uint8_t length = circularBuffer_peek(buffer, 0, max_length, &span);
+    if (length == 0 && max_length != 0)
+        _circularBuffer_recordFailedPop(buffer);
+
+    memcpy(data_out, span.first, span.first_length);
+    memcpy(data_out + span.first_length, span.second, span.second_length);
+
+    // Only update the front index once all of the data is copied out, so that a concurrent push never overwrites it
+    circularBuffer_release(buffer, length);
+
+    return length;
 }
 
-uint8_t _circularBuffer_getPhysicalIndex(circular_buffer_t* buffer, uint8_t index)
+#ifdef UTILS_QUEUE_STATS
+void circularBuffer_getStats(circular_buffer_t* buffer, queue_stats_t* stats_out)
 {
-    if (buffer->length - buffer->front_index > index)
-        return buffer->front_index + index;
-    else
-        return index - (buffer->length - buffer->front_index);
+    *stats_out = buffer->stats;
 }
 
-uint8_t _circularBuffer_getRelativeIndex(circular_buffer_t* buffer, uint8_t physical_index)
+void circularBuffer_resetStats(circular_buffer_t* buffer)
 {
-    if (physical_index >= buffer->front_index)
-        return physical_index - buffer->front_index;
-    else
-        return (buffer->length - buffer->front_index) + physical_index;
+    queueStats_reset(&buffer->stats);
 }
+#endif
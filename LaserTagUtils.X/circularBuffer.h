@@ -1,6 +1,9 @@
 #ifndef CIRCULARBUFFER_H
 #define CIRCULARBUFFER_H
 
+#include "queueStats.h"
+#include "utilsInline.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -9,50 +12,272 @@ typedef struct
     uint8_t* storage;
     // The length of the buffer in bytes. The buffer can store this many bytes minus 1
     uint8_t length;
+    // The length minus 1 if the length is a power of two, so that indices are wrapped with a mask rather than compared
+    // with the length. 0 otherwise
+    uint8_t mask;
     // Index of the first byte in the buffer
     uint8_t front_index;
     // Index one past the last byte in the buffer
     uint8_t back_index;
+#ifdef UTILS_QUEUE_STATS
+    queue_stats_t stats;
+#endif
 } circular_buffer_t;
 
+// A run of bytes in a circular buffer's storage. The bytes may wrap around the end of the storage, so they are given as
+// two contiguous segments. The second segment is empty if the bytes don't wrap
+typedef struct
+{
+    uint8_t* first;
+    uint8_t first_length;
+    uint8_t* second;
+    uint8_t second_length;
+} circular_buffer_span_t;
+
 // Create a circular buffer using the given storage. The created buffer can store one fewer than this many bytes. In
 // this context memory cannot be allocated dynamically, so the given storage is statically-allocated and deallocation is
-// not a concern.
+// not a concern. If the length is a power of two, indices are wrapped with a mask, which takes fewer instructions and
+// branches than comparing them with the length, e.g. in an interrupt handler.
 circular_buffer_t circularBuffer_create(uint8_t* storage, uint8_t length);
 
+// A note on thread safety: the indices are not volatile, so "mutually thread-safe" below relies on the compiler not
+// caching an index across a call. To share bytes between an interrupt handler and the main loop, use an SpscQueue,
+// which guarantees ordering.
+
 // Push a byte onto the front/back of the circular buffer. Returns false if the buffer is full, true otherwise.
 // pushFront and popBack are mutually thread-safe, as are pushBack and popFront.
 bool circularBuffer_pushFront(circular_buffer_t* buffer, uint8_t data);
-bool circularBuffer_pushBack(circular_buffer_t* buffer, uint8_t data);
+UTILS_INLINE bool circularBuffer_pushBack(circular_buffer_t* buffer, uint8_t data);
 // Pop a byte from the front/back of the circular buffer. Returns true and sets the out parameter to the popped byte if
 // there is at least one byte in the buffer, false otherwise. pushFront and popBack are mutually thread-safe, as are
 // pushBack and popFront.
-bool circularBuffer_popFront(circular_buffer_t* buffer, uint8_t* data_out);
+UTILS_INLINE bool circularBuffer_popFront(circular_buffer_t* buffer, uint8_t* data_out);
 bool circularBuffer_popBack(circular_buffer_t* buffer, uint8_t* data_out);
 
+// Push a span of bytes onto the back of the circular buffer. The bytes are copied in at most two contiguous segments,
+// and the back index is updated once. Returns false and pushes nothing if the buffer does not have enough free capacity
+// for all of the bytes, true otherwise. Mutually thread-safe with popFront and popSpan.
+bool circularBuffer_pushSpan(circular_buffer_t* buffer, uint8_t* data, uint8_t length);
+// Pop up to max_length bytes from the front of the circular buffer into data_out. The bytes are copied out in at most
+// two contiguous segments, and the front index is updated once. Returns the number of bytes popped, which is zero if
+// the buffer is empty. Mutually thread-safe with pushBack and pushSpan.
+uint8_t circularBuffer_popSpan(circular_buffer_t* buffer, uint8_t max_length, uint8_t* data_out);
+
+// Zero-copy access. These let a producer write directly into the buffer's storage and a consumer read directly out of
+// it, instead of copying through an intermediate array.
+//
+// Reserve space for the given number of bytes at the back of the buffer, and return where to write them. Returns false
+// and reserves nothing if the buffer does not have enough free capacity, true otherwise. The bytes are not in the
+// buffer until they are committed, so a concurrent pop never sees them part-written
+bool circularBuffer_reserve(circular_buffer_t* buffer, uint8_t length, circular_buffer_span_t* span_out);
+// Push the given number of bytes, which must have been reserved and written, onto the back of the buffer. Mutually
+// thread-safe with popFront, popSpan and release
+void circularBuffer_commit(circular_buffer_t* buffer, uint8_t length);
+// Return where to read up to max_length bytes starting at the given index of the buffer, without popping them. The
+// index is relative to the front of the buffer. Returns the number of bytes in the span, which is limited by the size
+// of the buffer
+uint8_t circularBuffer_peek(circular_buffer_t* buffer, uint8_t index, uint8_t max_length,
+                            circular_buffer_span_t* span_out);
+// Pop the given number of bytes, which must be no more than the size of the buffer, from the front of the buffer
+// without copying them. Mutually thread-safe with pushBack, pushSpan and commit
+void circularBuffer_release(circular_buffer_t* buffer, uint8_t length);
+
+// Get the byte at the given index of a span. The index must be less than the total length of the span
+uint8_t circularBuffer_spanGet(circular_buffer_span_t* span, uint8_t index);
+// Set the byte at the given index of a span, e.g. one returned by reserve. The index must be less than the total length
+// of the span
+void circularBuffer_spanSet(circular_buffer_span_t* span, uint8_t index, uint8_t data);
+// Drop the given number of bytes from the start of a span. The count must be no more than the total length of the span
+void circularBuffer_spanSkip(circular_buffer_span_t* span, uint8_t count);
+
 // Get the byte at the given index of the buffer. The index is relative to the front of the buffer. The given index must
 // be less than the current size of the buffer
-uint8_t circularBuffer_get(circular_buffer_t* buffer, uint8_t index);
+UTILS_INLINE uint8_t circularBuffer_get(circular_buffer_t* buffer, uint8_t index);
 // Set the byte at the given index of the buffer. The index is relative to the front of the buffer. The given index must
 // be less than the current size of the buffer
-void circularBuffer_set(circular_buffer_t* buffer, uint8_t index, uint8_t value);
+UTILS_INLINE void circularBuffer_set(circular_buffer_t* buffer, uint8_t index, uint8_t value);
 
 // Returns the address of the given index of the buffer. The index is relative to the front of the buffer. The given
 // index must be less than the current size of the buffer
-uint8_t* circularBuffer_at(circular_buffer_t* buffer, uint8_t index);
+UTILS_INLINE uint8_t* circularBuffer_at(circular_buffer_t* buffer, uint8_t index);
 
 // Capacity: the number of bytes that can fit in the buffer
-uint8_t circularBuffer_capacity(circular_buffer_t* buffer);
+UTILS_INLINE uint8_t circularBuffer_capacity(circular_buffer_t* buffer);
 // Size: the number of bytes that are in the buffer
-uint8_t circularBuffer_size(circular_buffer_t* buffer);
+UTILS_INLINE uint8_t circularBuffer_size(circular_buffer_t* buffer);
 // Free Capacity: capacity minus size
-uint8_t circularBuffer_freeCapacity(circular_buffer_t* buffer);
+UTILS_INLINE uint8_t circularBuffer_freeCapacity(circular_buffer_t* buffer);
+
+#ifdef UTILS_QUEUE_STATS
+// Copy out the buffer's stats. See queueStats.h
+void circularBuffer_getStats(circular_buffer_t* buffer, queue_stats_t* stats_out);
+void circularBuffer_resetStats(circular_buffer_t* buffer);
+#endif
 
 // -- For extension only --
 
 // Given an index, returns the associated physical index, i.e. the location of the data in the backing array
-uint8_t _circularBuffer_getPhysicalIndex(circular_buffer_t* buffer, uint8_t index);
+UTILS_INLINE uint8_t _circularBuffer_getPhysicalIndex(circular_buffer_t* buffer, uint8_t index);
 // Given a physical index, returns the associated relative index, i.e. the index relative to the queue's front index
-uint8_t _circularBuffer_getRelativeIndex(circular_buffer_t* buffer, uint8_t physical_index);
+UTILS_INLINE uint8_t _circularBuffer_getRelativeIndex(circular_buffer_t* buffer, uint8_t physical_index);
+
+// Record a successful push, or a failed push or pop, in the buffer's stats. These do nothing unless UTILS_QUEUE_STATS
+// is defined. Only pushes to the back and pops from the front are recorded, so that in a buffer shared with an
+// interrupt handler each side only writes its own stats. Extensions that reject a push or pop before it reaches the
+// buffer should record it here
+static inline void _circularBuffer_recordPush(circular_buffer_t* buffer)
+{
+#ifdef UTILS_QUEUE_STATS
+    queueStats_recordPush(&buffer->stats, _circularBuffer_getRelativeIndex(buffer, buffer->back_index),
+                          buffer->length - 1);
+#else
+    (void)buffer;
+#endif
+}
+
+static inline void _circularBuffer_recordFailedPush(circular_buffer_t* buffer)
+{
+#ifdef UTILS_QUEUE_STATS
+    queueStats_recordFailedPush(&buffer->stats);
+#else
+    (void)buffer;
+#endif
+}
+
+static inline void _circularBuffer_recordFailedPop(circular_buffer_t* buffer)
+{
+#ifdef UTILS_QUEUE_STATS
+    queueStats_recordFailedPop(&buffer->stats);
+#else
+    (void)buffer;
+#endif
+}
+
+// -- Hot functions. See utilsInline.h --
+
+#if defined(UTILS_STATIC_INLINE) || defined(CIRCULARBUFFER_IMPLEMENTATION)
+
+static inline uint8_t _circularBuffer_increment(circular_buffer_t* buffer, uint8_t index)
+{
+    // Increment our local copy
+    index++;
+
+    if (buffer->mask != 0)
+        return index & buffer->mask;
+
+    // Wrap around to zero if we're at the end
+    if (index == buffer->length)
+        return 0;
+
+    return index;
+}
+
+static inline uint8_t _circularBuffer_decrement(circular_buffer_t* buffer, uint8_t index)
+{
+    if (buffer->mask != 0)
+        return (uint8_t)(index - 1) & buffer->mask;
+
+    if (index == 0)
+        return buffer->length - 1;
+    else
+        return index - 1;
+}
+
+static inline bool _circularBuffer_isEmpty(circular_buffer_t* buffer)
+{
+    return buffer->back_index == buffer->front_index;
+}
+
+static inline bool _circularBuffer_isFull(circular_buffer_t* buffer)
+{
+    return buffer->back_index == _circularBuffer_decrement(buffer, buffer->front_index);
+}
+
+UTILS_INLINE bool circularBuffer_pushBack(circular_buffer_t* buffer, uint8_t data)
+{
+    if (_circularBuffer_isFull(buffer))
+    {
+        _circularBuffer_recordFailedPush(buffer);
+        return false;
+    }
+
+    buffer->storage[buffer->back_index] = data;
+    buffer->back_index = _circularBuffer_increment(buffer, buffer->back_index);
+    _circularBuffer_recordPush(buffer);
+
+    return true;
+}
+
+UTILS_INLINE bool circularBuffer_popFront(circular_buffer_t* buffer, uint8_t* data_out)
+{
+    if (_circularBuffer_isEmpty(buffer))
+    {
+        _circularBuffer_recordFailedPop(buffer);
+        return false;
+    }
+
+    *data_out = buffer->storage[buffer->front_index];
+    buffer->front_index = _circularBuffer_increment(buffer, buffer->front_index);
+
+    return true;
+}
+
+UTILS_INLINE uint8_t circularBuffer_get(circular_buffer_t* buffer, uint8_t index)
+{
+    return *circularBuffer_at(buffer, index);
+}
+
+UTILS_INLINE void circularBuffer_set(circular_buffer_t* buffer, uint8_t index, uint8_t value)
+{
+    *circularBuffer_at(buffer, index) = value;
+}
+
+UTILS_INLINE uint8_t* circularBuffer_at(circular_buffer_t* buffer, uint8_t index)
+{
+    if (index >= circularBuffer_capacity(buffer))
+        return 0;
+
+    return buffer->storage + _circularBuffer_getPhysicalIndex(buffer, index);
+}
+
+UTILS_INLINE uint8_t circularBuffer_capacity(circular_buffer_t* buffer)
+{
+    return buffer->length - 1;
+}
+
+UTILS_INLINE uint8_t circularBuffer_size(circular_buffer_t* buffer)
+{
+    // The relative index of the physical back index is the size of the buffer
+    return _circularBuffer_getRelativeIndex(buffer, buffer->back_index);
+}
+
+UTILS_INLINE uint8_t circularBuffer_freeCapacity(circular_buffer_t* buffer)
+{
+    return circularBuffer_capacity(buffer) - circularBuffer_size(buffer);
+}
+
+UTILS_INLINE uint8_t _circularBuffer_getPhysicalIndex(circular_buffer_t* buffer, uint8_t index)
+{
+    if (buffer->mask != 0)
+        return (uint8_t)(buffer->front_index + index) & buffer->mask;
+
+    if (buffer->length - buffer->front_index > index)
+        return buffer->front_index + index;
+    else
+        return index - (buffer->length - buffer->front_index);
+}
+
+UTILS_INLINE uint8_t _circularBuffer_getRelativeIndex(circular_buffer_t* buffer, uint8_t physical_index)
+{
+    if (buffer->mask != 0)
+        return (uint8_t)(physical_index - buffer->front_index) & buffer->mask;
+
+    if (physical_index >= buffer->front_index)
+        return physical_index - buffer->front_index;
+    else
+        return (buffer->length - buffer->front_index) + physical_index;
+}
+
+#endif
 
 #endif /* CIRCULARBUFFER_H */
@@ -0,0 +1,249 @@
+#include "fec.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The generator polynomial x^8 + x^5 + x^4 + x^3 + 1, minus its most significant term
+#define FEC_POLYNOMIAL 0x39
+
+// In FEC_CORRECTIONS, marks a syndrome that no error of one or two bits produces
+#define NO_CORRECTION 0xFFFF
+
+// The parity bits of every byte, precomputed with calculateParity. Being const, the table lives in program memory
+static const uint8_t FEC_PARITY[256] = {
+    0x00, 0x39, 0x72, 0x4B, 0xE4, 0xDD, 0x96, 0xAF, 0xF1, 0xC8, 0x83, 0xBA, 0x15, 0x2C, 0x67, 0x5E,
+    0xDB, 0xE2, 0xA9, 0x90, 0x3F, 0x06, 0x4D, 0x74, 0x2A, 0x13, 0x58, 0x61, 0xCE, 0xF7, 0xBC, 0x85,
+    0x8F, 0xB6, 0xFD, 0xC4, 0x6B, 0x52, 0x19, 0x20, 0x7E, 0x47, 0x0C, 0x35, 0x9A, 0xA3, 0xE8, 0xD1,
+    0x54, 0x6D, 0x26, 0x1F, 0xB0, 0x89, 0xC2, 0xFB, 0xA5, 0x9C, 0xD7, 0xEE, 0x41, 0x78, 0x33, 0x0A,
+    0x27, 0x1E, 0x55, 0x6C, 0xC3, 0xFA, 0xB1, 0x88, 0xD6, 0xEF, 0xA4, 0x9D, 0x32, 0x0B, 0x40, 0x79,
+    0xFC, 0xC5, 0x8E, 0xB7, 0x18, 0x21, 0x6A, 0x53, 0x0D, 0x34, 0x7F, 0x46, 0xE9, 0xD0, 0x9B, 0xA2,
+    0xA8, 0x91, 0xDA, 0xE3, 0x4C, 0x75, 0x3E, 0x07, 0x59, 0x60, 0x2B, 0x12, 0xBD, 0x84, 0xCF, 0xF6,
+    0x73, 0x4A, 0x01, 0x38, 0x97, 0xAE, 0xE5, 0xDC, 0x82, 0xBB, 0xF0, 0xC9, 0x66, 0x5F, 0x14, 0x2D,
+    0x4E, 0x77, 0x3C, 0x05, 0xAA, 0x93, 0xD8, 0xE1, 0xBF, 0x86, 0xCD, 0xF4, 0x5B, 0x62, 0x29, 0x10,
+    0x95, 0xAC, 0xE7, 0xDE, 0x71, 0x48, 0x03, 0x3A, 0x64, 0x5D, 0x16, 0x2F, 0x80, 0xB9, 0xF2, 0xCB,
+    0xC1, 0xF8, 0xB3, 0x8A, 0x25, 0x1C, 0x57, 0x6E, 0x30, 0x09, 0x42, 0x7B, 0xD4, 0xED, 0xA6, 0x9F,
+    0x1A, 0x23, 0x68, 0x51, 0xFE, 0xC7, 0x8C, 0xB5, 0xEB, 0xD2, 0x99, 0xA0, 0x0F, 0x36, 0x7D, 0x44,
+    0x69, 0x50, 0x1B, 0x22, 0x8D, 0xB4, 0xFF, 0xC6, 0x98, 0xA1, 0xEA, 0xD3, 0x7C, 0x45, 0x0E, 0x37,
+    0xB2, 0x8B, 0xC0, 0xF9, 0x56, 0x6F, 0x24, 0x1D, 0x43, 0x7A, 0x31, 0x08, 0xA7, 0x9E, 0xD5, 0xEC,
+    0xE6, 0xDF, 0x94, 0xAD, 0x02, 0x3B, 0x70, 0x49, 0x17, 0x2E, 0x65, 0x5C, 0xF3, 0xCA, 0x81, 0xB8,
+    0x3D, 0x04, 0x4F, 0x76, 0xD9, 0xE0, 0xAB, 0x92, 0xCC, 0xF5, 0xBE, 0x87, 0x28, 0x11, 0x5A, 0x63
+};
+
+// For each syndrome, the one or two bit error that produces it, as a mask of the data bits in the high byte and the
+// parity bits in the low byte, or NO_CORRECTION. The syndrome of a received codeword is the parity of its data XORed
+// with its parity bits, which cancels the data out and leaves the parity of the error. Because the code's minimum
+// distance is 5, every error of up to two bits has a different syndrome
+static const uint16_t FEC_CORRECTIONS[256] = {
+    0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x4020,
+    0x0008, 0x0009, 0x000A, 0xFFFF, 0x000C, 0xFFFF, 0x8040, 0x2080,
+    0x0010, 0x0011, 0x0012, 0xFFFF, 0x0014, 0x0C00, 0xFFFF, 0xFFFF,
+    0x0018, 0x0120, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x4100, 0xFFFF,
+    0x0020, 0x0021, 0x0022, 0x4004, 0x0024, 0x4002, 0x4001, 0x4000,
+    0x0028, 0x0110, 0x1800, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x4008,
+    0x0030, 0x0108, 0x0240, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x4010,
+    0x0101, 0x0100, 0xFFFF, 0x0102, 0x8200, 0x0104, 0xFFFF, 0x1400,
+    0x0040, 0x0041, 0x0042, 0xFFFF, 0x0044, 0xFFFF, 0x8008, 0xFFFF,
+    0x0048, 0xFFFF, 0x8004, 0x0300, 0x8002, 0xFFFF, 0x8000, 0x8001,
+    0x0050, 0xFFFF, 0x0220, 0xFFFF, 0x3000, 0x4200, 0xFFFF, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x1080, 0xFFFF, 0xFFFF, 0x8010, 0xFFFF,
+    0x0060, 0xFFFF, 0x0210, 0xFFFF, 0x0480, 0xFFFF, 0xFFFF, 0x4040,
+    0xFFFF, 0xC000, 0xFFFF, 0x2400, 0xFFFF, 0xFFFF, 0x8020, 0xFFFF,
+    0x0202, 0x0880, 0x0200, 0x0201, 0xFFFF, 0xFFFF, 0x0204, 0x8100,
+    0xFFFF, 0x0140, 0x0208, 0xFFFF, 0xFFFF, 0xFFFF, 0x2800, 0xFFFF,
+    0x0080, 0x0081, 0x0082, 0x0A00, 0x0084, 0xFFFF, 0xFFFF, 0x2008,
+    0x0088, 0xFFFF, 0xFFFF, 0x2004, 0xFFFF, 0x2002, 0x2001, 0x2000,
+    0x0090, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x9000, 0x0600, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0x1040, 0xFFFF, 0xFFFF, 0xFFFF, 0x2010,
+    0x00A0, 0xFFFF, 0xFFFF, 0xFFFF, 0x0440, 0xFFFF, 0xFFFF, 0x4080,
+    0x6000, 0x1200, 0x8400, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x2020,
+    0xFFFF, 0x0840, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x2100, 0xFFFF,
+    0xFFFF, 0x0180, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x8800,
+    0x00C0, 0xA000, 0xFFFF, 0x4400, 0x0420, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0900, 0xFFFF, 0xFFFF, 0x1010, 0xFFFF, 0xFFFF, 0x8080, 0x2040,
+    0xFFFF, 0x0820, 0xFFFF, 0x1008, 0xFFFF, 0xFFFF, 0x4800, 0xFFFF,
+    0xFFFF, 0x1002, 0x1001, 0x1000, 0xFFFF, 0x0500, 0xFFFF, 0x1004,
+    0x0404, 0x0810, 0x1100, 0xFFFF, 0x0400, 0x0401, 0x0402, 0xFFFF,
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x0408, 0xFFFF, 0xFFFF, 0xFFFF,
+    0x0801, 0x0800, 0x0280, 0x0802, 0x0410, 0x0804, 0xFFFF, 0xFFFF,
+    0xFFFF, 0x0808, 0xFFFF, 0x1020, 0x5000, 0x2200, 0xFFFF, 0xFFFF
+};
+
+// The parity of each 4-bit value
+static const uint8_t g_nibble_parities[16] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
+
+static uint8_t calculateParity(uint8_t data)
+{
+    uint8_t remainder = data;
+
+    // Polynomial division, as in calculateCRC
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if ((remainder & 0x80) != 0)
+            remainder = (uint8_t)(remainder << 1) ^ FEC_POLYNOMIAL;
+        else
+            remainder <<= 1;
+    }
+
+    return remainder;
+}
+
+// 1 if the byte has an odd number of set bits, 0 otherwise
+static uint8_t byteParity(uint8_t byte)
+{
+    return g_nibble_parities[byte >> 4] ^ g_nibble_parities[byte & 0x0F];
+}
+
+bool fec_tablesAreValid()
+{
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        if (FEC_PARITY[i] != calculateParity((uint8_t)i))
+            return false;
+
+        uint16_t correction = FEC_CORRECTIONS[i];
+        if (correction != NO_CORRECTION && (calculateParity(correction >> 8) ^ (uint8_t)correction) != i)
+            return false;
+    }
+
+    return true;
+}
+
+void fec_encode8(uint8_t data, uint8_t* codeword_out)
+{
+    uint8_t parity = FEC_PARITY[data];
+
+    codeword_out[0] = data;
+    codeword_out[1] = parity;
+    // Make the number of set bits in the whole codeword even
+    codeword_out[2] = (uint8_t)(byteParity(data ^ parity) << 7);
+}
+
+uint8_t fec_decode8(uint8_t* codeword, uint8_t* data_out)
+{
+    uint8_t data = codeword[0];
+    uint8_t parity = codeword[1];
+
+    uint8_t syndrome = FEC_PARITY[data] ^ parity;
+    // 1 if an odd number of bits were flipped
+    uint8_t odd_errors = byteParity(data ^ parity) ^ (codeword[2] >> 7);
+
+    if (syndrome == 0)
+    {
+        // The data and parity bits are intact. An odd count means the overall parity bit was flipped
+        *data_out = data;
+        return odd_errors;
+    }
+
+    uint16_t correction = FEC_CORRECTIONS[syndrome];
+    if (correction == NO_CORRECTION)
+        return FEC_UNCORRECTABLE;
+
+    // Clearing the lowest set bit leaves zero if and only if one bit is set
+    bool single_bit = (correction & (correction - 1)) == 0;
+    uint8_t corrected_count;
+    if (single_bit)
+    {
+        // Either one bit was flipped, or it and the overall parity bit were
+        corrected_count = odd_errors ? 1 : 2;
+    }
+    else
+    {
+        // Two bits were flipped. An odd count as well means at least three were, e.g. those two and the overall
+        // parity bit
+        if (odd_errors)
+            return FEC_UNCORRECTABLE;
+        corrected_count = 2;
+    }
+
+    *data_out = data ^ (uint8_t)(correction >> 8);
+    return corrected_count;
+}
+
+// The number of set bits in the byte
+static uint8_t countSetBits(uint8_t byte)
+{
+    uint8_t count = 0;
+    while (byte != 0)
+    {
+        // Clear the lowest set bit
+        byte &= byte - 1;
+        count++;
+    }
+
+    return count;
+}
+
+uint8_t fec_decode8WithErasures(uint8_t* codeword, uint8_t* erasures, uint8_t* data_out)
+{
+    // Split the erasure mask into one single-bit mask per erased bit
+    uint8_t erasure_bytes[FEC_MAX_ERASURES];
+    uint8_t erasure_masks[FEC_MAX_ERASURES];
+    uint8_t erasure_count = 0;
+    for (uint8_t byte_index = 0; byte_index < FEC_CODEWORD_BYTES; byte_index++)
+    {
+        uint8_t remaining = erasures[byte_index];
+        // Ignore bits after the end of the codeword
+        if (byte_index == FEC_CODEWORD_BYTES - 1)
+            remaining &= 0x80;
+
+        while (remaining != 0)
+        {
+            if (erasure_count == FEC_MAX_ERASURES)
+                return fec_decode8(codeword, data_out);
+
+            uint8_t lowest_bit = remaining & (uint8_t)(~remaining + 1);
+            erasure_bytes[erasure_count] = byte_index;
+            erasure_masks[erasure_count] = lowest_bit;
+            erasure_count++;
+            remaining &= ~lowest_bit;
+        }
+    }
+
+    if (erasure_count == 0)
+        return fec_decode8(codeword, data_out);
+
+    // The most other errors that can be corrected alongside the erasures
+    uint8_t max_errors = (5 - erasure_count) >> 1;
+
+    uint8_t best_errors = FEC_UNCORRECTABLE;
+    uint8_t best_data = 0;
+
+    uint8_t candidate[FEC_CODEWORD_BYTES];
+    uint8_t combination_count = (uint8_t)(1 << erasure_count);
+    for (uint8_t combination = 0; combination < combination_count; combination++)
+    {
+        for (uint8_t i = 0; i < FEC_CODEWORD_BYTES; i++)
+            candidate[i] = codeword[i];
+
+        // Flip the erased bits selected by the combination
+        uint8_t selection = combination;
+        for (uint8_t i = 0; i < erasure_count; i++)
+        {
+            if (selection & 1)
+                candidate[erasure_bytes[i]] ^= erasure_masks[i];
+            selection >>= 1;
+        }
+
+        uint8_t data;
+        uint8_t errors = fec_decode8(candidate, &data);
+        if (errors <= max_errors && errors < best_errors)
+        {
+            best_errors = errors;
+            best_data = data;
+        }
+    }
+
+    if (best_errors == FEC_UNCORRECTABLE)
+        return fec_decode8(codeword, data_out);
+
+    *data_out = best_data;
+
+    // The corrections may have flipped some erased bits back, so count the difference from the received codeword
+    // rather than adding up the flips. Bits after the end of the codeword are ignored
+    uint8_t decoded[FEC_CODEWORD_BYTES];
+    fec_encode8(best_data, decoded);
+    uint8_t difference = countSetBits(decoded[0] ^ codeword[0]) + countSetBits(decoded[1] ^ codeword[1])
+                         + countSetBits((decoded[2] ^ codeword[2]) & 0x80);
+
+    return difference;
+}
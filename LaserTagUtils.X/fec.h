@@ -0,0 +1,47 @@
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Forward error correction for 8 bits of data. Each byte is sent as a 17-bit codeword that corrects any one or two
+// flipped bits and detects any three, so a shot with a bit or two flipped at long range is still registered rather
+// than dropped.
+//
+// The code is the [17, 9, 5] quadratic residue code shortened to 8 data bits, which has a minimum distance of 5,
+// extended with an overall parity bit to a minimum distance of 6. A codeword is the data byte, then 8 parity bits,
+// then the overall parity bit in the most significant bit of the third byte. The parity bits are the remainder of the
+// data divided by x^8 + x^5 + x^4 + x^3 + 1, computed in the same way as a CRC. Encoding and decoding are table
+// lookups, with both tables in program memory.
+
+// The length of a codeword in bits, and in bytes
+#define FEC_CODEWORD_LENGTH 17
+#define FEC_CODEWORD_BYTES 3
+
+// Returned by fec_decode8 if the codeword has more errors than can be corrected
+#define FEC_UNCORRECTABLE 0xFF
+
+// The most erasures that fec_decode8WithErasures tries every value of. Each one doubles the number of decodes
+#define FEC_MAX_ERASURES 4
+
+// Checks the precomputed tables against the code they are generated from. Returns false if they are out of date. Slow,
+// so call it once at startup
+bool fec_tablesAreValid(void);
+
+// Encodes the given data as a codeword. codeword_out must point to FEC_CODEWORD_BYTES bytes. Bits after the end of the
+// codeword are cleared
+void fec_encode8(uint8_t data, uint8_t* codeword_out);
+// Decodes the given codeword, correcting up to two bit errors. Returns the number of bits corrected and copies the
+// data into the out parameter, or returns FEC_UNCORRECTABLE if there are too many errors to correct. Three errors are
+// always detected, and more are detected unless they happen to be within two bits of another codeword. The contents of
+// data_out are undefined when this function returns FEC_UNCORRECTABLE
+uint8_t fec_decode8(uint8_t* codeword, uint8_t* data_out);
+// Same as fec_decode8, but takes a mask, in the same layout as the codeword, of bits that are unreliable, e.g. from
+// soft decisions. A code with minimum distance 6 can correct e errors and f of these erasures whenever 2e + f <= 5, so
+// knowing which bits are suspect lets it correct more of them. Tries every value of the erased bits, and returns the
+// decode that needs the fewest other corrections within that limit. If there are more than FEC_MAX_ERASURES erasures,
+// or no decode is within the limit, falls back to fec_decode8. Returns the number of bits that differ from the
+// received codeword, or FEC_UNCORRECTABLE
+uint8_t fec_decode8WithErasures(uint8_t* codeword, uint8_t* erasures, uint8_t* data_out);
+
+#endif /* FEC_H */
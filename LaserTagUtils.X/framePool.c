@@ -0,0 +1,69 @@
+#include "framePool.h"
+
+#include <stdint.h>
+
+frame_pool_t framePool_create(uint8_t* storage, uint16_t length, uint8_t frame_size)
+{
+    // Any more frames and the last one's handle would be FRAME_POOL_NO_FRAME, and the count wouldn't fit in a byte
+    uint16_t fitting_frame_count = length / ((uint16_t)frame_size + 1);
+    uint8_t frame_count
+        = fitting_frame_count < FRAME_POOL_MAX_FRAME_COUNT ? (uint8_t)fitting_frame_count : FRAME_POOL_MAX_FRAME_COUNT;
+
+    frame_pool_t pool = {
+        .frames = storage,
+        .next_frames = storage + (uint16_t)frame_count * frame_size,
+        .frame_size = frame_size,
+        .frame_count = frame_count,
+        .free_frame = frame_count != 0 ? 0 : FRAME_POOL_NO_FRAME,
+        .free_frame_count = frame_count,
+    };
+
+    // Chain all of the frames into the free list. With no frames there's no list, and no link to write
+    if (frame_count == 0)
+        return pool;
+
+    for (uint8_t i = 0; i < frame_count; i++)
+        pool.next_frames[i] = i + 1;
+    pool.next_frames[frame_count - 1] = FRAME_POOL_NO_FRAME;
+
+    return pool;
+}
+
+frame_handle_t framePool_allocate(frame_pool_t* pool)
+{
+    if (pool->free_frame_count == 0)
+        return FRAME_POOL_NO_FRAME;
+
+    frame_handle_t frame = pool->free_frame;
+    pool->free_frame = pool->next_frames[frame];
+    pool->free_frame_count--;
+
+    return frame;
+}
+
+void framePool_free(frame_pool_t* pool, frame_handle_t frame)
+{
+    pool->next_frames[frame] = pool->free_frame;
+    pool->free_frame = frame;
+    pool->free_frame_count++;
+}
+
+uint8_t* framePool_getFrame(frame_pool_t* pool, frame_handle_t frame)
+{
+    return pool->frames + (uint16_t)frame * pool->frame_size;
+}
+
+uint8_t framePool_frameSize(frame_pool_t* pool)
+{
+    return pool->frame_size;
+}
+
+uint8_t framePool_frameCount(frame_pool_t* pool)
+{
+    return pool->frame_count;
+}
+
+uint8_t framePool_freeFrameCount(frame_pool_t* pool)
+{
+    return pool->free_frame_count;
+}
@@ -0,0 +1,60 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <stdint.h>
+
+// A FramePool hands out fixed-size frames from static storage. Allocating and freeing a frame are both O(1). Code can
+// pass a frame's handle around instead of copying its bytes through a queue, and the worst-case RAM use is fixed when
+// the pool is created.
+//
+// Frames are allocated and freed from one context only, e.g. the main loop, as the free list is not thread-safe. To
+// hand a frame to another context, e.g. an interrupt handler, push its handle through an SpscQueue. The other context
+// owns the frame until it passes the handle back the same way, to be freed by the pool's context.
+
+// Identifies a frame in a pool
+typedef uint8_t frame_handle_t;
+
+// Returned when there are no free frames, and can be used to mark that a handle variable holds no frame
+#define FRAME_POOL_NO_FRAME 0xFF
+// The most frames a pool can hold, so that every frame's handle is less than FRAME_POOL_NO_FRAME
+#define FRAME_POOL_MAX_FRAME_COUNT (FRAME_POOL_NO_FRAME)
+
+// The number of bytes of storage needed for a pool with the given number of frames of the given size. Each frame costs
+// one byte on top of its size, for its link in the free list
+#define FRAME_POOL_STORAGE_LENGTH(frame_size, frame_count) (((frame_size) + 1) * (frame_count))
+
+typedef struct
+{
+    uint8_t* frames;
+    // For each frame, the next frame in the free list
+    uint8_t* next_frames;
+    uint8_t frame_size;
+    uint8_t frame_count;
+    uint8_t free_frame;
+    uint8_t free_frame_count;
+} frame_pool_t;
+
+// Create a pool of frames of the given size using the given storage. In this context memory cannot be allocated
+// dynamically, so the given storage is statically-allocated and deallocation is not a concern. Use
+// FRAME_POOL_STORAGE_LENGTH to size the storage.
+// The storage length is 16 bits, so that a pool can hold more than 255 bytes of frames. The pool holds as many frames as
+// fit, up to FRAME_POOL_MAX_FRAME_COUNT, and none if the storage is too short for one. Check framePool_frameCount
+frame_pool_t framePool_create(uint8_t* storage, uint16_t length, uint8_t frame_size);
+
+// Take a frame from the pool. Returns FRAME_POOL_NO_FRAME if there are no free frames. The frame's contents are not
+// cleared
+frame_handle_t framePool_allocate(frame_pool_t* pool);
+// Return a frame to the pool. The frame must have been allocated from this pool and not already freed
+void framePool_free(frame_pool_t* pool, frame_handle_t frame);
+
+// Returns the address of the given frame's bytes
+uint8_t* framePool_getFrame(frame_pool_t* pool, frame_handle_t frame);
+
+// The number of bytes in each frame
+uint8_t framePool_frameSize(frame_pool_t* pool);
+// The number of frames in the pool, allocated or not
+uint8_t framePool_frameCount(frame_pool_t* pool);
+// The number of frames that can still be allocated
+uint8_t framePool_freeFrameCount(frame_pool_t* pool);
+
+#endif /* FRAMEPOOL_H */
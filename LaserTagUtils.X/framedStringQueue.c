@@ -0,0 +1,191 @@
+#include "framedStringQueue.h"
+
+#include "circularBuffer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+framed_string_queue_t framedStringQueue_create(uint8_t* storage, uint8_t length)
+{
+    framed_string_queue_t queue = {
+        .buffer = circularBuffer_create(storage, length),
+        .full_string_count = 0,
+        .has_partial_string = false,
+        .partial_string_length = 0,
+    };
+
+    return queue;
+}
+
+bool framedStringQueue_push(framed_string_queue_t* queue, uint8_t* string, uint8_t string_length)
+{
+    return framedStringQueue_pushPartial(queue, string, string_length, true);
+}
+
+bool framedStringQueue_pushPartial(framed_string_queue_t* queue, uint8_t* partial_string, uint8_t partial_string_length,
+                                   bool is_end_of_string)
+{
+    if (partial_string_length != 0)
+    {
+        // A new string needs room for its header as well as its bytes
+        uint8_t required_capacity = partial_string_length;
+        if (!queue->has_partial_string)
+            required_capacity++;
+
+        // Check for overflow of the required capacity as well as for the queue being too full
+        if (required_capacity < partial_string_length || framedStringQueue_freeCapacity(queue) < required_capacity)
+        {
+            _circularBuffer_recordFailedPush(&queue->buffer);
+            return false;
+        }
+
+        if (!queue->has_partial_string)
+        {
+            // Push a placeholder header. We'll fill it in when the string is complete
+            circularBuffer_pushBack(&queue->buffer, 0);
+            queue->has_partial_string = true;
+            queue->partial_string_length = 0;
+        }
+
+        circularBuffer_pushSpan(&queue->buffer, partial_string, partial_string_length);
+        queue->partial_string_length += partial_string_length;
+    }
+
+    // If there is no partial string there is nothing to mark as complete
+    if (is_end_of_string && queue->has_partial_string)
+    {
+        // The header sits immediately before the bytes of the partial string remaining in the queue
+        uint8_t header_index = circularBuffer_size(&queue->buffer) - queue->partial_string_length - 1;
+        circularBuffer_set(&queue->buffer, header_index, queue->partial_string_length);
+
+        queue->has_partial_string = false;
+        queue->full_string_count++;
+    }
+
+    return true;
+}
+
+bool framedStringQueue_pop(framed_string_queue_t* queue, uint8_t max_length, uint8_t* data_out, uint8_t* length_out)
+{
+    if (circularBuffer_size(&queue->buffer) == 0)
+    {
+        _circularBuffer_recordFailedPop(&queue->buffer);
+        *length_out = 0;
+        return false;
+    }
+
+    // Strings are completed in order, so if there are no full strings the string at the front is the partial string
+    bool front_is_partial = queue->full_string_count == 0;
+
+    uint8_t header;
+    circularBuffer_popFront(&queue->buffer, &header);
+
+    // The header of a partial string is a placeholder
+    uint8_t remaining_length = front_is_partial ? queue->partial_string_length : header;
+
+    uint8_t length = remaining_length;
+    if (length > max_length)
+        length = max_length;
+
+    circularBuffer_popSpan(&queue->buffer, length, data_out);
+    *length_out = length;
+
+    bool popped_end_of_string = !front_is_partial && length == remaining_length;
+
+    if (popped_end_of_string)
+    {
+        queue->full_string_count--;
+    }
+    else
+    {
+        // Put the header back in front of the remaining bytes, with the remaining length. This always succeeds, since
+        // we just popped at least the old header
+        circularBuffer_pushFront(&queue->buffer, remaining_length - length);
+
+        if (front_is_partial)
+            queue->partial_string_length -= length;
+    }
+
+    return popped_end_of_string;
+}
+
+uint8_t framedStringQueue_capacity(framed_string_queue_t* queue)
+{
+    return circularBuffer_capacity(&queue->buffer);
+}
+
+uint8_t framedStringQueue_size(framed_string_queue_t* queue)
+{
+    return circularBuffer_size(&queue->buffer);
+}
+
+uint8_t framedStringQueue_freeCapacity(framed_string_queue_t* queue)
+{
+    return circularBuffer_freeCapacity(&queue->buffer);
+}
+
+bool framedStringQueue_hasFullString(framed_string_queue_t* queue)
+{
+    return queue->full_string_count != 0;
+}
+
+uint8_t framedStringQueue_peekStringLength(framed_string_queue_t* queue)
+{
+    return circularBuffer_get(&queue->buffer, 0);
+}
+
+uint8_t framedStringQueue_peek(framed_string_queue_t* queue, circular_buffer_span_t* span_out)
+{
+    uint8_t length = 0;
+    if (queue->full_string_count != 0)
+        length = framedStringQueue_peekStringLength(queue);
+
+    // The string's bytes start after its header
+    return circularBuffer_peek(&queue->buffer, 1, length, span_out);
+}
+
+bool framedStringQueue_reserve(framed_string_queue_t* queue, uint8_t string_length, circular_buffer_span_t* span_out)
+{
+    // The header goes in front of a partial string's bytes, so nothing can be pushed until it's complete. Check for
+    // overflow of the length with its header too
+    if (queue->has_partial_string || string_length == 0xFF)
+    {
+        _circularBuffer_recordFailedPush(&queue->buffer);
+        return false;
+    }
+
+    // Reserve room for the header too, and write it now, since its value is already known
+    if (!circularBuffer_reserve(&queue->buffer, string_length + 1, span_out))
+        return false;
+
+    circularBuffer_spanSet(span_out, 0, string_length);
+    circularBuffer_spanSkip(span_out, 1);
+
+    return true;
+}
+
+void framedStringQueue_commit(framed_string_queue_t* queue, uint8_t string_length)
+{
+    // Push the header along with the bytes of the string
+    circularBuffer_commit(&queue->buffer, string_length + 1);
+    queue->full_string_count++;
+}
+
+void framedStringQueue_release(framed_string_queue_t* queue)
+{
+    // Pop the header along with the bytes of the string
+    circularBuffer_release(&queue->buffer, framedStringQueue_peekStringLength(queue) + 1);
+    queue->full_string_count--;
+}
+
+#ifdef UTILS_QUEUE_STATS
+void framedStringQueue_getStats(framed_string_queue_t* queue, queue_stats_t* stats_out)
+{
+    circularBuffer_getStats(&queue->buffer, stats_out);
+}
+
+void framedStringQueue_resetStats(framed_string_queue_t* queue)
+{
+    circularBuffer_resetStats(&queue->buffer);
+}
+#endif
@@ -0,0 +1,77 @@
+#ifndef FRAMEDSTRINGQUEUE_H
+#define FRAMEDSTRINGQUEUE_H
+
+#include "circularBuffer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A FramedStringQueue is a queue of variable-length strings, like a StringQueue, that frames each string with a
+// one-byte length header instead of a parallel array of end-of-string flags. Together with a count of completed
+// strings, this makes hasFullString and peekStringLength O(1), and removes the flag array. The cost is one byte of
+// storage per string in the queue rather than one bit per byte of storage, which is cheaper for all but very short
+// strings.
+//
+// The header of a string that is still being pushed is a placeholder until the string is completed. The header of a
+// partially-popped string holds the number of bytes of the string remaining in the queue.
+
+typedef struct
+{
+    circular_buffer_t buffer;
+    // The number of complete strings in the queue, including a partially-popped one
+    uint8_t full_string_count;
+    // True if a partial string is being pushed, i.e. a header has been pushed for a string that is not yet complete
+    bool has_partial_string;
+    // The number of bytes of the partial string being pushed that are still in the queue
+    uint8_t partial_string_length;
+} framed_string_queue_t;
+
+// Create a queue using the given storage. In this context memory cannot be allocated dynamically, so the given storage
+// is statically-allocated and deallocation is not a concern.
+framed_string_queue_t framedStringQueue_create(uint8_t* storage, uint8_t length);
+
+// See stringQueue_push
+bool framedStringQueue_push(framed_string_queue_t* queue, uint8_t* string, uint8_t string_length);
+// See stringQueue_pushPartial
+bool framedStringQueue_pushPartial(framed_string_queue_t* queue, uint8_t* partial_string, uint8_t partial_string_length,
+                                   bool is_end_of_string);
+// See stringQueue_pop
+bool framedStringQueue_pop(framed_string_queue_t* queue, uint8_t max_length, uint8_t* data_out, uint8_t* length_out);
+
+// The total number of bytes the queue can hold, including one header byte per string
+uint8_t framedStringQueue_capacity(framed_string_queue_t* queue);
+// The number of bytes currently in the queue, including header bytes and bytes of a partially-added string, if any
+uint8_t framedStringQueue_size(framed_string_queue_t* queue);
+// The difference between capacity and size
+uint8_t framedStringQueue_freeCapacity(framed_string_queue_t* queue);
+
+#ifdef UTILS_QUEUE_STATS
+// See circularBuffer_getStats
+void framedStringQueue_getStats(framed_string_queue_t* queue, queue_stats_t* stats_out);
+void framedStringQueue_resetStats(framed_string_queue_t* queue);
+#endif
+
+// Returns true if the queue contains at least one full string. Returns false if the queue is empty or only contains a
+// partial string. O(1)
+bool framedStringQueue_hasFullString(framed_string_queue_t* queue);
+
+// Zero-copy push. Reserve room for a string of the given length at the back of the queue, and return where to write
+// it. Returns false and reserves nothing if the queue is too full, or a partial string is being pushed. The string is
+// not in the queue until it is committed
+bool framedStringQueue_reserve(framed_string_queue_t* queue, uint8_t string_length, circular_buffer_span_t* span_out);
+// Push the string of the given length, which must have been reserved and written, onto the back of the queue
+void framedStringQueue_commit(framed_string_queue_t* queue, uint8_t string_length);
+
+// Zero-copy access to the string at the front of the queue, or to the bytes remaining of it if it has been partially
+// popped. Returns where to read the string in the queue's storage, and the string's length. Returns zero if the queue
+// does not contain a full string
+uint8_t framedStringQueue_peek(framed_string_queue_t* queue, circular_buffer_span_t* span_out);
+// Pop the string at the front of the queue without copying it out, e.g. once it has been read in place after a call to
+// peek. The queue must contain at least one full string
+void framedStringQueue_release(framed_string_queue_t* queue);
+
+// Peek at the length of the string at the front of the queue, or at the number of bytes remaining if it has been
+// partially popped. The queue must contain at least one full string. O(1)
+uint8_t framedStringQueue_peekStringLength(framed_string_queue_t* queue);
+
+#endif /* FRAMEDSTRINGQUEUE_H */
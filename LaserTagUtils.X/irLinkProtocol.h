@@ -0,0 +1,126 @@
+#ifndef IRLINKPROTOCOL_H
+#define IRLINKPROTOCOL_H
+
+#include "bitArray.h"
+
+#include <stdint.h>
+
+// The I2C protocol between the main processor, LaserTag.X, and the IR transceiver, LaserTagTransceiver.X. Both include
+// this header, so that an option that changes the bytes of a message can't be set on one side and not the other, which
+// would put the main processor's reads out of step with what the transceiver sends.
+//
+// The main processor sends a transmission as a message of its length in bits, then its data. A message that starts
+// with a value greater than MAX_TRANSMISSION_LENGTH is a command instead. The transceiver sends each transmission it
+// receives as its length in bits, then RECEIVED_TRANSMISSION_DATA_BYTES of data, and sends reports in place of a
+// transmission, starting with a marker greater than MAX_TRANSMISSION_LENGTH in place of the length.
+
+// Send the main processor a reliability flag for every bit of each received transmission, after its data. A bit is
+// flagged as unreliable if its pulse width was close to the edge of the window for a zero or a one. A pulse just
+// outside a window is decoded as the nearer bit and flagged, rather than discarding the transmission, so that the main
+// processor can try correcting the flagged bits. Doubles the RAM used for received transmissions on both processors
+#undef SOFT_DECISION
+
+// Receive with two sensors, e.g. on opposite sides of a vest, rather than one. The transceiver decodes each on its own.
+// A transmission both sensors decoded the same is sent to the main processor once. With SOFT_DECISION, bits that either
+// sensor flagged as unreliable needn't match, and are taken from the sensor that received them reliably. If the sensors
+// decoded it differently, both are sent, with the second marked with ALTERNATE_TRANSMISSION_FLAG. Every received
+// transmission is followed by a byte of flags for the sensors that received it
+#undef DUAL_SENSOR
+
+// Max transmission length in bits. Short enough that the transceiver can send it with a training preamble and frame
+// header, which take room in its queue of outgoing pulses, so that a message the main processor may send always fits.
+// See MAX_FRAMED_TRANSMISSION_LENGTH in LaserTagTransceiver.X/IRTransmitter.c
+#define MAX_TRANSMISSION_LENGTH 112
+
+// Sent to the main processor in place of a transmission length, to say that receive failure counts follow instead of
+// a transmission. Must be greater than MAX_TRANSMISSION_LENGTH, as must each of the markers and commands below
+#define RECEIVE_FAILURE_REPORT_MARKER 0xFF
+// Sent to the main processor in place of a transmission length, to say that an ir_receiver_telemetry_t follows instead
+// of a transmission
+#define TELEMETRY_REPORT_MARKER 0xFE
+
+// Sent by the main processor in place of a transmission length, as a message on its own, to ask for a telemetry report
+// or to reset the telemetry counters
+#define TELEMETRY_REQUEST_COMMAND 0xFF
+#define TELEMETRY_RESET_COMMAND 0xFE
+
+// Why a received transmission was discarded. A receive failure report holds the number of new failures for each of
+// these causes, in this order, so the main processor may add causes of its own after them. A transmission is counted
+// once, for the first failure found in it. Two transmitters firing at once usually show up as
+// IR_RECEIVE_FAILURE_OVERLAP, but can show up as any of these
+typedef enum {
+    // A pulse was neither a zero nor a one, and wasn't long enough to be two pulses run together
+    IR_RECEIVE_FAILURE_INVALID_PULSE,
+    // A gap between pulses was longer than a pulse gap but shorter than a transmission gap, e.g. a pulse was missed
+    IR_RECEIVE_FAILURE_INVALID_GAP,
+    // The transmission was longer than MAX_TRANSMISSION_LENGTH, e.g. two transmissions ran together
+    IR_RECEIVE_FAILURE_TOO_LONG,
+    // A pulse was longer than a one, or a gap was shorter than any pulse gap. This is the shape of another
+    // transmitter's pulses landing on or between ours
+    IR_RECEIVE_FAILURE_OVERLAP,
+    // All of the transceiver's received transmission slots were full, because its main loop hadn't collected them
+    IR_RECEIVE_FAILURE_NO_FREE_SLOT,
+    // The transmission's training preamble was cut short or didn't look like one. Only with TRAINING_PREAMBLE. See
+    // transmissionConstants.h in LaserTagTransceiver.X
+    IR_RECEIVE_FAILURE_INVALID_PREAMBLE,
+    // A pulse ended while the previous one was still being handled, so its measurement may have been missed
+    IR_RECEIVE_FAILURE_MISSED_PULSE,
+    // The transmission was received, but dropped to make room for a newer one because the main processor wasn't
+    // collecting them fast enough
+    IR_RECEIVE_FAILURE_DROPPED,
+    // The transmission didn't start with the start-of-frame delimiter, or declared a length of zero or more than
+    // MAX_TRANSMISSION_LENGTH. Only with FRAME_HEADER
+    IR_RECEIVE_FAILURE_INVALID_HEADER,
+    // The transmission ended before its header or all of its declared length had arrived. Only with FRAME_HEADER, or
+    // with GAP_MODULATION, where it's a transmission that ended before any of its data
+    IR_RECEIVE_FAILURE_TRUNCATED,
+    // The number of causes in a receive failure report
+    TRANSCEIVER_RECEIVE_FAILURE_COUNT
+} ir_receive_failure_t;
+
+// Counts of what the transceiver's receiver has seen, for measuring reception quality. Every count wraps at 65536. With
+// DUAL_SENSOR, pulses, transmissions and failures are counted for each sensor, except that a transmission both sensors
+// received is queued and counted once. A telemetry report is this struct as laid out in the transceiver's memory, which
+// both processors lay out the same
+typedef struct
+{
+    // Pulses measured, whether or not they were decoded
+    uint16_t pulses;
+    // Gaps long enough to end a transmission
+    uint16_t long_gaps;
+    // Transmissions decoded and queued to be sent to the main processor
+    uint16_t transmissions_received;
+    // Transmissions discarded for any reason. See ir_receive_failure_t for the reasons
+    uint16_t transmissions_discarded;
+    // Transmissions discarded because the queue of received transmissions was full
+    uint16_t queue_overflows;
+    // Transmissions discarded for being longer than MAX_TRANSMISSION_LENGTH
+    uint16_t too_long_transmissions;
+    // Transmissions collected from the queue to be sent to the main processor
+    uint16_t transmissions_collected;
+} ir_receiver_telemetry_t;
+
+// The number of bytes of data sent to the main processor for a received transmission of the given length in bits,
+// after the length: the data, then its reliability flags with SOFT_DECISION
+#ifdef SOFT_DECISION
+#define RECEIVED_TRANSMISSION_DATA_BYTES(num_bits) (NUM_BYTES(num_bits) << 1)
+#else
+#define RECEIVED_TRANSMISSION_DATA_BYTES(num_bits) NUM_BYTES(num_bits)
+#endif
+// The number of bytes sent for a received transmission of the given length in bits, after the length: its data, then
+// its sensor flags with DUAL_SENSOR
+#ifdef DUAL_SENSOR
+#define RECEIVED_TRANSMISSION_BYTES(num_bits) (RECEIVED_TRANSMISSION_DATA_BYTES(num_bits) + 1)
+#else
+#define RECEIVED_TRANSMISSION_BYTES(num_bits) RECEIVED_TRANSMISSION_DATA_BYTES(num_bits)
+#endif
+
+// The sensor flags that follow a received transmission with DUAL_SENSOR, for the sensors that received it
+#define SENSOR_1_FLAG 0x01
+#define SENSOR_2_FLAG 0x02
+// Set as well as the sensor flag on a transmission that the second sensor received at the same time as the first
+// sensor received the transmission before it, but decoded differently, e.g. with a bit error. They're most likely the
+// same transmission, so at most one of the two should be used
+#define ALTERNATE_TRANSMISSION_FLAG 0x80
+
+#endif /* IRLINKPROTOCOL_H */
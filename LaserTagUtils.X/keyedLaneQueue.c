@@ -0,0 +1,221 @@
+#include "keyedLaneQueue.h"
+
+#include "bitArray.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>  // for memcpy
+
+keyed_lane_queue_t keyedLaneQueue_create(uint8_t* storage, uint8_t length)
+{
+    // Each block needs its data bytes, one byte of end-of-string flags, and one byte for the index of the next block
+    uint8_t block_count = length / (KEYED_LANE_QUEUE_BLOCK_SIZE + 2);
+
+    keyed_lane_queue_t queue = {
+        .blocks = storage,
+        .next_blocks = storage + block_count * KEYED_LANE_QUEUE_BLOCK_SIZE,
+        .string_end_flags = storage + block_count * (KEYED_LANE_QUEUE_BLOCK_SIZE + 1),
+        .block_count = block_count,
+        .free_block = 0,
+        .free_block_count = block_count,
+    };
+
+    // Chain all of the blocks into the free list
+    for (uint8_t i = 0; i < block_count; i++)
+        queue.next_blocks[i] = i + 1;
+    queue.next_blocks[block_count - 1] = KEYED_LANE_QUEUE_NO_BLOCK;
+
+    for (uint8_t i = 0; i < KEYED_LANE_QUEUE_LANE_COUNT; i++)
+        queue.lanes[i].head_block = KEYED_LANE_QUEUE_NO_BLOCK;
+
+    return queue;
+}
+
+static keyed_lane_queue_lane_t* findLane(keyed_lane_queue_t* queue, uint8_t key)
+{
+    for (uint8_t i = 0; i < KEYED_LANE_QUEUE_LANE_COUNT; i++)
+    {
+        keyed_lane_queue_lane_t* lane = &queue->lanes[i];
+        if (lane->head_block != KEYED_LANE_QUEUE_NO_BLOCK && lane->key == key)
+            return lane;
+    }
+
+    return 0;
+}
+
+static keyed_lane_queue_lane_t* findUnusedLane(keyed_lane_queue_t* queue)
+{
+    for (uint8_t i = 0; i < KEYED_LANE_QUEUE_LANE_COUNT; i++)
+    {
+        keyed_lane_queue_lane_t* lane = &queue->lanes[i];
+        if (lane->head_block == KEYED_LANE_QUEUE_NO_BLOCK)
+            return lane;
+    }
+
+    return 0;
+}
+
+// Take a block from the free list. There must be at least one free block
+static uint8_t allocateBlock(keyed_lane_queue_t* queue)
+{
+    uint8_t block = queue->free_block;
+    queue->free_block = queue->next_blocks[block];
+    queue->free_block_count--;
+
+    queue->next_blocks[block] = KEYED_LANE_QUEUE_NO_BLOCK;
+    // Clear all of the block's end-of-string flags at once, so that pushes don't have to clear them byte by byte
+    queue->string_end_flags[block] = 0;
+
+    return block;
+}
+
+static void freeBlock(keyed_lane_queue_t* queue, uint8_t block)
+{
+    queue->next_blocks[block] = queue->free_block;
+    queue->free_block = block;
+    queue->free_block_count++;
+}
+
+bool keyedLaneQueue_push(keyed_lane_queue_t* queue, uint8_t key, uint8_t* string, uint8_t string_length)
+{
+    return keyedLaneQueue_pushPartial(queue, key, string, string_length, true);
+}
+
+bool keyedLaneQueue_pushPartial(keyed_lane_queue_t* queue, uint8_t key, uint8_t* partial_string,
+                                uint8_t partial_string_length, bool is_end_of_string)
+{
+    keyed_lane_queue_lane_t* lane = findLane(queue, key);
+
+    if (lane == 0)
+    {
+        // Nothing to push, and no byte to mark as the end of a string
+        if (partial_string_length == 0)
+            return true;
+
+        // Check for space before claiming a lane, so that a failed push doesn't leave an empty lane behind
+        if (queue->free_block_count * KEYED_LANE_QUEUE_BLOCK_SIZE < partial_string_length)
+            return false;
+
+        lane = findUnusedLane(queue);
+        if (lane == 0)
+            return false;
+
+        lane->key = key;
+        lane->head_block = allocateBlock(queue);
+        lane->tail_block = lane->head_block;
+        lane->head_offset = 0;
+        lane->tail_offset = 0;
+        lane->full_string_count = 0;
+    }
+
+    // Check that the string fits in the rest of the tail block plus the free blocks
+    uint8_t free_space
+        = queue->free_block_count * KEYED_LANE_QUEUE_BLOCK_SIZE + (KEYED_LANE_QUEUE_BLOCK_SIZE - lane->tail_offset);
+    if (free_space < partial_string_length)
+        return false;
+
+    while (partial_string_length != 0)
+    {
+        if (lane->tail_offset == KEYED_LANE_QUEUE_BLOCK_SIZE)
+        {
+            uint8_t block = allocateBlock(queue);
+            queue->next_blocks[lane->tail_block] = block;
+            lane->tail_block = block;
+            lane->tail_offset = 0;
+        }
+
+        // Copy as much as fits in the tail block
+        uint8_t chunk_length = KEYED_LANE_QUEUE_BLOCK_SIZE - lane->tail_offset;
+        if (chunk_length > partial_string_length)
+            chunk_length = partial_string_length;
+
+        memcpy(queue->blocks + lane->tail_block * KEYED_LANE_QUEUE_BLOCK_SIZE + lane->tail_offset, partial_string,
+               chunk_length);
+
+        lane->tail_offset += chunk_length;
+        partial_string += chunk_length;
+        partial_string_length -= chunk_length;
+    }
+
+    // An empty lane has no byte to mark, and marking an already-marked byte would count the same string twice
+    uint8_t* tail_flags = queue->string_end_flags + lane->tail_block;
+    bool is_lane_empty = lane->head_block == lane->tail_block && lane->head_offset == lane->tail_offset;
+    if (is_end_of_string && !is_lane_empty && !bitArray_getBit(tail_flags, lane->tail_offset - 1))
+    {
+        bitArray_setBit(tail_flags, lane->tail_offset - 1, true);
+        lane->full_string_count++;
+    }
+
+    return true;
+}
+
+bool keyedLaneQueue_pop(keyed_lane_queue_t* queue, uint8_t key, uint8_t max_length, uint8_t* data_out,
+                        uint8_t* length_out)
+{
+    bool found_last_byte = false;
+    uint8_t length = 0;
+
+    keyed_lane_queue_lane_t* lane = findLane(queue, key);
+
+    if (lane != 0)
+    {
+        while (length < max_length && !found_last_byte)
+        {
+            bool is_tail_block = lane->head_block == lane->tail_block;
+            uint8_t block_end = is_tail_block ? lane->tail_offset : KEYED_LANE_QUEUE_BLOCK_SIZE;
+
+            // The lane is empty
+            if (is_tail_block && lane->head_offset == block_end)
+                break;
+
+            uint8_t* block_data = queue->blocks + lane->head_block * KEYED_LANE_QUEUE_BLOCK_SIZE;
+            uint8_t* block_flags = queue->string_end_flags + lane->head_block;
+
+            // Copy bytes out of the head block until we reach the end of the block, the end of a string or the
+            // maximum length
+            while (lane->head_offset != block_end && length < max_length && !found_last_byte)
+            {
+                data_out[length] = block_data[lane->head_offset];
+                found_last_byte = bitArray_getBit(block_flags, lane->head_offset);
+
+                lane->head_offset++;
+                length++;
+            }
+
+            // Move on to the next block once the head block has been used up. Keep the tail block, as it's still being
+            // pushed into
+            if (lane->head_offset == KEYED_LANE_QUEUE_BLOCK_SIZE && !is_tail_block)
+            {
+                uint8_t next_block = queue->next_blocks[lane->head_block];
+                freeBlock(queue, lane->head_block);
+                lane->head_block = next_block;
+                lane->head_offset = 0;
+            }
+        }
+
+        if (found_last_byte)
+            lane->full_string_count--;
+
+        // Release the lane and its last block once it's empty, so that other keys can use them
+        if (lane->head_block == lane->tail_block && lane->head_offset == lane->tail_offset)
+        {
+            freeBlock(queue, lane->head_block);
+            lane->head_block = KEYED_LANE_QUEUE_NO_BLOCK;
+        }
+    }
+
+    *length_out = length;
+    return found_last_byte;
+}
+
+bool keyedLaneQueue_hasFullString(keyed_lane_queue_t* queue, uint8_t key)
+{
+    keyed_lane_queue_lane_t* lane = findLane(queue, key);
+
+    return lane != 0 && lane->full_string_count != 0;
+}
+
+uint8_t keyedLaneQueue_freeCapacity(keyed_lane_queue_t* queue)
+{
+    return queue->free_block_count * KEYED_LANE_QUEUE_BLOCK_SIZE;
+}
@@ -0,0 +1,82 @@
+#ifndef KEYEDLANEQUEUE_H
+#define KEYEDLANEQUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A KeyedLaneQueue is a queue of variable-length strings, each tagged with a one-byte key, e.g. an I2C address. Strings
+// with the same key are kept in order in their own lane, and all lanes share one storage pool. Unlike
+// keyedStringQueue, finding the strings for a key does not scan the queue, and popping a string does not compact the
+// strings queued ahead of it. Popping a string of length m is O(m), regardless of how many other strings are queued.
+//
+// The pool is divided into blocks of KEYED_LANE_QUEUE_BLOCK_SIZE bytes. Each lane is a linked list of blocks. Blocks
+// are taken from a free list as strings are pushed and returned to it as strings are popped. Each block has a byte of
+// end-of-string flags, one bit per data byte, and a byte linking it to the next block in its lane.
+
+// The number of data bytes per block. Must be 8 so that each block's end-of-string flags fit in one byte
+#define KEYED_LANE_QUEUE_BLOCK_SIZE 8
+
+// Marks the end of a list of blocks, or an unused lane
+#define KEYED_LANE_QUEUE_NO_BLOCK 0xFF
+
+// The maximum number of distinct keys that can have strings in the queue at the same time
+#ifndef KEYED_LANE_QUEUE_LANE_COUNT
+#define KEYED_LANE_QUEUE_LANE_COUNT 4
+#endif
+
+typedef struct
+{
+    uint8_t key;
+    // Index of the block holding the front of the lane, or KEYED_LANE_QUEUE_NO_BLOCK if the lane is unused
+    uint8_t head_block;
+    // Index of the block holding the back of the lane
+    uint8_t tail_block;
+    // Offset of the first byte of the lane in the head block
+    uint8_t head_offset;
+    // Offset one past the last byte of the lane in the tail block
+    uint8_t tail_offset;
+    // The number of complete strings in the lane, including a partially-popped one
+    uint8_t full_string_count;
+} keyed_lane_queue_lane_t;
+
+typedef struct
+{
+    uint8_t* blocks;
+    // For each block, the index of the next block in its lane or in the free list
+    uint8_t* next_blocks;
+    // For each block, one bit per data byte indicating that the byte is the last byte of a string. Bit order matches
+    // bitArray
+    uint8_t* string_end_flags;
+    uint8_t block_count;
+    uint8_t free_block;
+    uint8_t free_block_count;
+    keyed_lane_queue_lane_t lanes[KEYED_LANE_QUEUE_LANE_COUNT];
+} keyed_lane_queue_t;
+
+// Create a queue using the given storage. In this context memory cannot be allocated dynamically, so the given storage
+// is statically-allocated and deallocation is not a concern. Each block costs KEYED_LANE_QUEUE_BLOCK_SIZE + 2 bytes of
+// storage, so the number of bytes that can be stored is 80% of length, rounded down to a whole number of blocks.
+keyed_lane_queue_t keyedLaneQueue_create(uint8_t* storage, uint8_t length);
+
+// Push a string with the given key onto the back of that key's lane. Returns false if the queue does not have enough
+// free space for the string, or if the key has no lane and all lanes are in use, true otherwise. Not thread safe
+bool keyedLaneQueue_push(keyed_lane_queue_t* queue, uint8_t key, uint8_t* string, uint8_t string_length);
+// Push part of a string with the given key. The final parameter indicates whether this push concludes the string. If
+// the final parameter is `true` and the given partial string length is `0`, marks the most recently added byte with the
+// given key as the end of the string
+bool keyedLaneQueue_pushPartial(keyed_lane_queue_t* queue, uint8_t key, uint8_t* partial_string,
+                                uint8_t partial_string_length, bool is_end_of_string);
+// Pop a string with the given key. Takes the maximum number of bytes to pop. Returns true if the last byte popped is
+// the last byte of a string, false otherwise. Returns the data and the length of the returned data as two out
+// parameters. A return value of false with a returned data length of zero indicates that there is no data with the
+// given key. Partial strings can be popped.
+bool keyedLaneQueue_pop(keyed_lane_queue_t* queue, uint8_t key, uint8_t max_length, uint8_t* data_out,
+                        uint8_t* length_out);
+
+// Returns true if the queue contains at least one full string with the given key. O(KEYED_LANE_QUEUE_LANE_COUNT)
+bool keyedLaneQueue_hasFullString(keyed_lane_queue_t* queue, uint8_t key);
+
+// The number of data bytes that can still be pushed, across all lanes, if they were all pushed to new lanes
+uint8_t keyedLaneQueue_freeCapacity(keyed_lane_queue_t* queue);
+
+#endif /* KEYEDLANEQUEUE_H */
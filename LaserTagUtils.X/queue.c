@@ -1,3 +1,5 @@
+// Compile the hot functions defined in the header
+#define QUEUE_IMPLEMENTATION
 #include "queue.h"
 
 #include "circularBuffer.h"
@@ -7,26 +9,24 @@ queue_t queue_create(uint8_t* storage, uint8_t length)
     return circularBuffer_create(storage, length);
 }
 
-bool queue_push(queue_t* queue, uint8_t data)
+bool queue_pushSpan(queue_t* queue, uint8_t* data, uint8_t length)
 {
-    return circularBuffer_pushBack(queue, data);
+    return circularBuffer_pushSpan(queue, data, length);
 }
 
-bool queue_pop(queue_t* queue, uint8_t* data_out)
+uint8_t queue_popSpan(queue_t* queue, uint8_t max_length, uint8_t* data_out)
 {
-    return circularBuffer_popFront(queue, data_out);
+    return circularBuffer_popSpan(queue, max_length, data_out);
 }
 
-uint8_t queue_capacity(queue_t* queue)
+#ifdef UTILS_QUEUE_STATS
+void queue_getStats(queue_t* queue, queue_stats_t* stats_out)
 {
-    return circularBuffer_capacity(queue);
-}
-uint8_t queue_size(queue_t* queue)
-{
-    return circularBuffer_size(queue);
+    circularBuffer_getStats(queue, stats_out);
 }
 
-uint8_t queue_freeCapacity(queue_t* queue)
+void queue_resetStats(queue_t* queue)
 {
-    return circularBuffer_freeCapacity(queue);
+    circularBuffer_resetStats(queue);
 }
+#endif
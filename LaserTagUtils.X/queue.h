@@ -2,6 +2,7 @@
 #define QUEUE_H
 
 #include "circularBuffer.h"
+#include "utilsInline.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -12,12 +13,53 @@ typedef circular_buffer_t queue_t;
 queue_t queue_create(uint8_t* storage, uint8_t length);
 
 // See circularBuffer_pushBack
-bool queue_push(queue_t* queue, uint8_t data);
+UTILS_INLINE bool queue_push(queue_t* queue, uint8_t data);
 // See circularBuffer_popFront
-bool queue_pop(queue_t* queue, uint8_t* data_out);
+UTILS_INLINE bool queue_pop(queue_t* queue, uint8_t* data_out);
+// See circularBuffer_pushSpan
+bool queue_pushSpan(queue_t* queue, uint8_t* data, uint8_t length);
+// See circularBuffer_popSpan
+uint8_t queue_popSpan(queue_t* queue, uint8_t max_length, uint8_t* data_out);
 
-uint8_t queue_capacity(queue_t* queue);
-uint8_t queue_size(queue_t* queue);
-uint8_t queue_freeCapacity(queue_t* queue);
+UTILS_INLINE uint8_t queue_capacity(queue_t* queue);
+UTILS_INLINE uint8_t queue_size(queue_t* queue);
+UTILS_INLINE uint8_t queue_freeCapacity(queue_t* queue);
+
+#ifdef UTILS_QUEUE_STATS
+// See circularBuffer_getStats
+void queue_getStats(queue_t* queue, queue_stats_t* stats_out);
+void queue_resetStats(queue_t* queue);
+#endif
+
+// -- Hot functions. See utilsInline.h --
+
+#if defined(UTILS_STATIC_INLINE) || defined(QUEUE_IMPLEMENTATION)
+
+UTILS_INLINE bool queue_push(queue_t* queue, uint8_t data)
+{
+    return circularBuffer_pushBack(queue, data);
+}
+
+UTILS_INLINE bool queue_pop(queue_t* queue, uint8_t* data_out)
+{
+    return circularBuffer_popFront(queue, data_out);
+}
+
+UTILS_INLINE uint8_t queue_capacity(queue_t* queue)
+{
+    return circularBuffer_capacity(queue);
+}
+
+UTILS_INLINE uint8_t queue_size(queue_t* queue)
+{
+    return circularBuffer_size(queue);
+}
+
+UTILS_INLINE uint8_t queue_freeCapacity(queue_t* queue)
+{
+    return circularBuffer_freeCapacity(queue);
+}
+
+#endif
 
 #endif /* QUEUE_H */
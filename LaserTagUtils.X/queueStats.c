@@ -0,0 +1,51 @@
+#include "queueStats.h"
+
+#include <stdint.h>
+
+static void incrementSaturating(uint16_t* count)
+{
+    if (*count != 0xFFFF)
+        (*count)++;
+}
+
+void queueStats_reset(queue_stats_t* stats)
+{
+    stats->high_water_mark = 0;
+    stats->failed_pushes = 0;
+    stats->failed_pops = 0;
+
+    for (uint8_t i = 0; i < QUEUE_STATS_HISTOGRAM_BINS; i++)
+        stats->occupancy_histogram[i] = 0;
+}
+
+void queueStats_recordPush(queue_stats_t* stats, uint8_t size, uint8_t capacity)
+{
+    if (size > stats->high_water_mark)
+        stats->high_water_mark = size;
+
+    // Find the size's quarter of capacity by comparison, as PIC16 has no hardware multiply or divide
+    uint8_t quarter = capacity >> 2;
+    uint8_t half = capacity >> 1;
+    uint8_t bin;
+
+    if (size < quarter)
+        bin = 0;
+    else if (size < half)
+        bin = 1;
+    else if (size < half + quarter)
+        bin = 2;
+    else
+        bin = 3;
+
+    incrementSaturating(&stats->occupancy_histogram[bin]);
+}
+
+void queueStats_recordFailedPush(queue_stats_t* stats)
+{
+    incrementSaturating(&stats->failed_pushes);
+}
+
+void queueStats_recordFailedPop(queue_stats_t* stats)
+{
+    incrementSaturating(&stats->failed_pops);
+}
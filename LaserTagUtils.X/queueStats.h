@@ -0,0 +1,43 @@
+#ifndef QUEUESTATS_H
+#define QUEUESTATS_H
+
+#include <stdint.h>
+
+// QueueStats record how full a queue gets, so that its storage can be sized from real use rather than guesswork.
+//
+// Recording is a project-wide compile-time option, off by default. Define UTILS_QUEUE_STATS for the whole project, e.g.
+// in the compiler's preprocessor macros, to add a queue_stats_t to every circular buffer, queue, string queue, framed
+// string queue, SpscQueue and typed queue, and to declare the functions that read and reset them. Without it, queues
+// are unchanged and recording compiles to nothing.
+//
+// The stats of a queue that is shared with an interrupt handler have one writer per field: pushes, which record the
+// high water mark, failed pushes and the histogram, happen in one context, and pops, which record failed pops, happen
+// in the other. Reading and resetting them is not thread-safe, so mask the queue's interrupts around both.
+
+// The number of bins in the occupancy histogram. Each bin covers a quarter of the queue's capacity
+#define QUEUE_STATS_HISTOGRAM_BINS 4
+
+typedef struct
+{
+    // The most bytes, or elements, that have been in the queue at once
+    uint8_t high_water_mark;
+    // The number of pushes that failed because the queue was full. Saturates at 0xFFFF
+    uint16_t failed_pushes;
+    // The number of pops that failed because the queue was empty. Saturates at 0xFFFF. Queues that are polled count
+    // every poll that finds them empty
+    uint16_t failed_pops;
+    // The size of the queue just after each successful push, counted by quarter of capacity. E.g. bin 0 counts pushes
+    // that left the queue less than a quarter full, and bin 3 counts pushes that left it at least three quarters full.
+    // Each bin saturates at 0xFFFF
+    uint16_t occupancy_histogram[QUEUE_STATS_HISTOGRAM_BINS];
+} queue_stats_t;
+
+// Clear all of the stats
+void queueStats_reset(queue_stats_t* stats);
+
+// Record a successful push that left the queue holding size of its capacity
+void queueStats_recordPush(queue_stats_t* stats, uint8_t size, uint8_t capacity);
+void queueStats_recordFailedPush(queue_stats_t* stats);
+void queueStats_recordFailedPop(queue_stats_t* stats);
+
+#endif /* QUEUESTATS_H */
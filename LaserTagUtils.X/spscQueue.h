@@ -0,0 +1,157 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include "queueStats.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// An SpscQueue is a single-producer, single-consumer queue of bytes for passing data between an interrupt handler and
+// the main loop without masking interrupts. Its length is a power of two known at compile time and its storage is
+// embedded in the queue, so there is no runtime length field. Indices are wrapped with a mask rather than compared
+// against the length, so wrapping an index or computing the size never branches. This matters on PIC16, where there is
+// no barrel shifter and every branch costs two cycles, and where these operations run inside interrupt handlers.
+//
+// Ownership: exactly one context pushes, and exactly one other context pops. The producer is the only writer of the
+// back index and the consumer is the only writer of the front index. Each side reads the other side's index once per
+// call, so it works from a consistent snapshot even if it is interrupted by the other side part way through.
+//
+// Ordering: the indices and storage are volatile, so the compiler keeps every access and keeps them in program order.
+// The producer writes a byte before publishing the back index that covers it, and the consumer reads a byte before
+// publishing the front index that releases it. Indices are single bytes, which PIC16 reads and writes atomically, so
+// neither side can see a half-written index. Together these guarantee that the consumer never reads a byte before it
+// is written, and that the producer never overwrites a byte before it is read.
+//
+// The snapshot of the other side's index can only be stale in the safe direction: the producer may see less free
+// capacity than there is, and the consumer may see fewer bytes than there are.
+//
+// Usage:
+//
+//     static SPSC_QUEUE_T(256) g_queue;
+//     spscQueue_initialize(&g_queue);
+//     // In the producer
+//     spscQueue_push(&g_queue, 42);
+//     // In the consumer
+//     spscQueue_pop(&g_queue, &data);
+
+typedef struct
+{
+    // Index of the first byte in the queue. Written only by the consumer
+    volatile uint8_t front_index;
+    // Index one past the last byte in the queue. Written only by the producer
+    volatile uint8_t back_index;
+#ifdef UTILS_QUEUE_STATS
+    queue_stats_t stats;
+#endif
+} spsc_queue_indices_t;
+
+// Evaluates to the given length if it is a power of two between 2 and 256 inclusive, and to -1 otherwise
+#define SPSC_QUEUE_CHECKED_LENGTH(length) \
+    ((((length) & ((length)-1)) == 0 && (length) >= 2 && (length) <= 256) ? (length) : -1)
+
+// Declares a queue type with the given length. The length must be a power of two between 2 and 256 inclusive. Any other
+// length produces a negative array size, i.e. a compile error
+#define SPSC_QUEUE_T(length)                                         \
+    struct                                                           \
+    {                                                                \
+        spsc_queue_indices_t indices;                                \
+        volatile uint8_t storage[SPSC_QUEUE_CHECKED_LENGTH(length)]; \
+    }
+
+// The mask that wraps an index into the given queue's storage
+#define SPSC_QUEUE_MASK(queue) ((uint8_t)(sizeof((queue)->storage) - 1))
+
+// Initialize the queue. Must not be called while either side may be using the queue
+#define spscQueue_initialize(queue) _spscQueue_initialize(&(queue)->indices)
+
+// Producer only. Returns false if the queue is full, true otherwise
+#define spscQueue_push(queue, data) \
+    _spscQueue_push(&(queue)->indices, (queue)->storage, SPSC_QUEUE_MASK(queue), (data))
+// Producer only. A lower bound on the number of bytes that can be pushed
+#define spscQueue_freeCapacity(queue) (SPSC_QUEUE_MASK(queue) - spscQueue_size(queue))
+
+// Consumer only. Returns false if the queue is empty, true otherwise
+#define spscQueue_pop(queue, data_out) \
+    _spscQueue_pop(&(queue)->indices, (queue)->storage, SPSC_QUEUE_MASK(queue), (data_out))
+
+// The number of bytes in the queue. Safe from either side. A lower bound when called by the consumer, and an upper
+// bound when called by the producer
+#define spscQueue_size(queue) _spscQueue_size(&(queue)->indices, SPSC_QUEUE_MASK(queue))
+#define spscQueue_capacity(queue) SPSC_QUEUE_MASK(queue)
+
+#ifdef UTILS_QUEUE_STATS
+// Copy out or clear the queue's stats. See queueStats.h
+#define spscQueue_getStats(queue, stats_out) (*(stats_out) = (queue)->indices.stats)
+#define spscQueue_resetStats(queue) queueStats_reset(&(queue)->indices.stats)
+#endif
+
+// -- Implementation. Use the macros above --
+
+static inline void _spscQueue_initialize(spsc_queue_indices_t* indices)
+{
+    indices->front_index = 0;
+    indices->back_index = 0;
+#ifdef UTILS_QUEUE_STATS
+    queueStats_reset(&indices->stats);
+#endif
+}
+
+static inline uint8_t _spscQueue_size(spsc_queue_indices_t* indices, uint8_t mask)
+{
+    // Read each index exactly once
+    uint8_t front_index = indices->front_index;
+    uint8_t back_index = indices->back_index;
+
+    return (uint8_t)(back_index - front_index) & mask;
+}
+
+static inline bool _spscQueue_push(spsc_queue_indices_t* indices, volatile uint8_t* storage, uint8_t mask,
+                                   uint8_t data)
+{
+    // The producer owns the back index, so its own copy can't change under it
+    uint8_t back_index = indices->back_index;
+    uint8_t next_back_index = (back_index + 1) & mask;
+
+    uint8_t front_index = indices->front_index;
+
+    if (next_back_index == front_index)
+    {
+#ifdef UTILS_QUEUE_STATS
+        queueStats_recordFailedPush(&indices->stats);
+#endif
+        return false;
+    }
+
+    storage[back_index] = data;
+    // Publish the byte
+    indices->back_index = next_back_index;
+
+#ifdef UTILS_QUEUE_STATS
+    queueStats_recordPush(&indices->stats, (uint8_t)(next_back_index - front_index) & mask, mask);
+#endif
+
+    return true;
+}
+
+static inline bool _spscQueue_pop(spsc_queue_indices_t* indices, volatile uint8_t* storage, uint8_t mask,
+                                  uint8_t* data_out)
+{
+    // The consumer owns the front index, so its own copy can't change under it
+    uint8_t front_index = indices->front_index;
+
+    if (front_index == indices->back_index)
+    {
+#ifdef UTILS_QUEUE_STATS
+        queueStats_recordFailedPop(&indices->stats);
+#endif
+        return false;
+    }
+
+    *data_out = storage[front_index];
+    // Release the byte's slot back to the producer
+    indices->front_index = (front_index + 1) & mask;
+
+    return true;
+}
+
+#endif /* SPSCQUEUE_H */
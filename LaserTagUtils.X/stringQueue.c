@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>  // for memset
 
 string_queue_t stringQueue_create(uint8_t* storage, uint8_t length)
 {
@@ -19,6 +20,10 @@ string_queue_t stringQueue_create(uint8_t* storage, uint8_t length)
     string_queue_t string_queue = {.buffer = circularBuffer_create(storage, byte_queue_length),
                                    .string_end_flags = storage + byte_queue_length};
 
+    // End-of-string flags are only ever set for bytes that end a string in the queue, and are cleared when that byte is
+    // popped. Pushes rely on this to avoid clearing the flag of every byte they push, so start with all flags clear
+    memset(string_queue.string_end_flags, 0, bitarray_length);
+
     return string_queue;
 }
 
@@ -32,50 +37,76 @@ bool stringQueue_pushPartial(string_queue_t* queue, uint8_t* partial_string, uin
 {
     // Check if the bytes of the string will fit in the byte queue
     if (stringQueue_freeCapacity(queue) < partial_string_length)
-        return false;
-
-    for (uint8_t i = 0; i < partial_string_length; i++)
     {
-        circularBuffer_pushBack(&queue->buffer, partial_string[i]);
-        // Clear the end-of-string flag, in case it was set before
-        _stringQueue_setIsEndOfString(queue, circularBuffer_size(&queue->buffer), false);
+        _circularBuffer_recordFailedPush(&queue->buffer);
+        return false;
     }
 
-    if (is_end_of_string)
+    // The end-of-string flags of the pushed bytes are already clear, because flags are cleared as their strings are
+    // popped
+    circularBuffer_pushSpan(&queue->buffer, partial_string, partial_string_length);
+
+    // If the queue is empty there is no byte to mark, and setting the flag at index 0 would leave behind a stale flag
+    uint8_t size = circularBuffer_size(&queue->buffer);
+    if (is_end_of_string && size != 0)
     {
         // Indicate that the last byte in the queue is the end of a string
-        _stringQueue_setIsEndOfString(queue, circularBuffer_size(&queue->buffer), true);
+        _stringQueue_setIsEndOfString(queue, size, true);
     }
 
     return true;
 }
 
-bool stringQueue_pop(string_queue_t* queue, uint8_t max_length, uint8_t* data_out, uint8_t* length_out)
+// Find the first byte flagged as the end of a string among the given number of bytes starting at the given index.
+// Returns the number of bytes up to and including that byte, or zero if none of the bytes end a string
+static uint8_t findEndOfString(string_queue_t* queue, uint8_t index, uint8_t count)
 {
-    bool found_last_byte = false;
+    if (count == 0)
+        return 0;
+
+    // The flags line up with exclusive end indexes, so the flag for the byte at the given index is at the next index
+    uint8_t start_bit_index = _circularBuffer_getPhysicalIndex(&queue->buffer, index + 1);
+
+    // The flags may wrap around the end of the buffer, in which case search them in two ranges
+    uint8_t count_before_end = queue->buffer.length - start_bit_index;
+    uint8_t first_count = count < count_before_end ? count : count_before_end;
+    uint8_t second_count = count - first_count;
+
+    uint8_t end_bit_index
+        = bitArray_findFirstSet(queue->string_end_flags, start_bit_index, start_bit_index + first_count);
+    if (end_bit_index != start_bit_index + first_count)
+        return end_bit_index - start_bit_index + 1;
+
+    end_bit_index = bitArray_findFirstSet(queue->string_end_flags, 0, second_count);
+    if (end_bit_index != second_count)
+        return first_count + end_bit_index + 1;
 
+    return 0;
+}
+
+bool stringQueue_pop(string_queue_t* queue, uint8_t max_length, uint8_t* data_out, uint8_t* length_out)
+{
     uint8_t queue_size = stringQueue_size(queue);
+    if (queue_size == 0)
+        _circularBuffer_recordFailedPop(&queue->buffer);
     if (max_length > queue_size)
         max_length = queue_size;
 
-    uint8_t i = 0;
-    // No need to check for an empty byte queue - the last byte will be flagged
-    // as the end of a string
-    while (i < max_length && !found_last_byte)
-    {
-        circularBuffer_popFront(&queue->buffer, data_out + i);
-        // We just popped a byte from the front of the queue, so index 0 points one past that byte
-        found_last_byte = _stringQueue_getIsEndOfString(queue, 0);
+    // Find the number of bytes to pop before popping any of them, so that they can be copied out in one span
+    uint8_t length = findEndOfString(queue, 0, max_length);
+    bool found_last_byte = length != 0;
+    if (!found_last_byte)
+        length = max_length;
 
-        i++;
-    }
+    circularBuffer_popSpan(&queue->buffer, length, data_out);
 
     if (found_last_byte)
     {
+        // We just popped the end of the string from the front of the queue, so index 0 points one past that byte
         _stringQueue_setIsEndOfString(queue, 0, false);
     }
 
-    *length_out = i;
+    *length_out = length;
 
     return found_last_byte;
 }
@@ -95,18 +126,6 @@ uint8_t stringQueue_freeCapacity(string_queue_t* queue)
     return circularBuffer_freeCapacity(&queue->buffer);
 }
 
-static uint8_t increment(uint8_t index, uint8_t end)
-{
-    // Increment our local copy
-    index++;
-
-    // Wrap around to zero if we're at the end
-    if (index == end)
-        return 0;
-
-    return index;
-}
-
 bool stringQueue_hasFullString(string_queue_t* queue)
 {
     return stringQueue_hasFullStringAt(queue, 0);
@@ -114,68 +133,18 @@ bool stringQueue_hasFullString(string_queue_t* queue)
 
 bool stringQueue_hasFullStringAt(string_queue_t* queue, uint8_t index)
 {
-    // If there are any set bits in the "end of string" flag array bytes covering the range between the given relative
-    // index and the end of the queue, then there is a full string in the queue
-
-    if (stringQueue_size(queue) == 0)
+    // If any of the bytes between the given index and the end of the queue are flagged as the end of a string, then
+    // there is a full string in the queue
+    uint8_t size = stringQueue_size(queue);
+    if (index >= size)
         return false;
 
-    // Length of the "end of string" flag array in bytes
-    uint8_t bitarray_length = (queue->buffer.length + 7) >> 3;
-
-    // Inclusive start index into bits of the bitarray
-    uint8_t start_bit_index = _circularBuffer_getPhysicalIndex(&queue->buffer, index + 1);
-    // *Inclusive* end index into bits of the bitarray
-    uint8_t inclusive_end_bit_index = queue->buffer.back_index;
-
-    // Inclusive start index into bytes of the bitarray
-    uint8_t start_byte_index = start_bit_index >> 3;
-    // *Inclusive* end index into bytes of the bitarray
-    uint8_t inclusive_end_byte_index = inclusive_end_bit_index >> 3;
-    // Exclusive end index into bytes of the bitarray
-    uint8_t end_byte_index = increment(inclusive_end_byte_index, bitarray_length);
-
-    uint8_t start_byte_mask = ~(((uint8_t)(~0)) << (8 - (start_bit_index & 0b111)));
-    uint8_t end_byte_mask = ~(((uint8_t)(~0)) >> ((inclusive_end_bit_index & 0b111) + 1));
-
-    uint8_t byte_index = start_byte_index;
-
-    while (byte_index != end_byte_index)
-    {
-        uint8_t byte_value = *(queue->string_end_flags + byte_index);
-        if (byte_index == start_byte_index)
-        {
-            if (byte_index == inclusive_end_byte_index)
-                start_byte_mask &= end_byte_mask;
-
-            if ((byte_value & start_byte_mask) != 0)
-                return true;
-        }
-        else if (byte_index == inclusive_end_byte_index)
-        {
-            if ((byte_value & end_byte_mask) != 0)
-                return true;
-        }
-        else
-        {
-            if (byte_value != 0)
-                return true;
-        }
-
-        byte_index = increment(byte_index, bitarray_length);
-    }
-
-    return false;
+    return findEndOfString(queue, index, size - index) != 0;
 }
 
 uint8_t stringQueue_peekStringLength(string_queue_t* queue)
 {
-    uint8_t index = 0;
-
-    while (!_stringQueue_getIsEndOfString(queue, index))
-        index++;
-
-    return index;
+    return findEndOfString(queue, 0, stringQueue_size(queue));
 }
 
 bool _stringQueue_getIsEndOfString(string_queue_t* queue, uint8_t index)
@@ -191,19 +160,20 @@ void _stringQueue_setIsEndOfString(string_queue_t* queue, uint8_t index, bool is
 bool _stringQueue_popMiddle(string_queue_t* queue, uint8_t index, uint8_t max_length, uint8_t* data_out,
                             uint8_t* length_out)
 {
-    bool found_last_byte = false;
-
-    uint8_t i = 0;
+    uint8_t size = stringQueue_size(queue);
+    if (index > size)
+        index = size;
+    if (max_length > size - index)
+        max_length = size - index;
 
-    while (i < max_length && !found_last_byte)
-    {
-        data_out[i] = circularBuffer_get(&queue->buffer, index + i);
-        // Increment before checking the string end flag, because the string end flags line up with exclusive end
-        // indexes
-        i++;
+    // Find the number of bytes to pop before copying any of them out
+    uint8_t i = findEndOfString(queue, index, max_length);
+    bool found_last_byte = i != 0;
+    if (!found_last_byte)
+        i = max_length;
 
-        found_last_byte = _stringQueue_getIsEndOfString(queue, index + i);
-    }
+    for (uint8_t j = 0; j < i; j++)
+        data_out[j] = circularBuffer_get(&queue->buffer, index + j);
 
     if (found_last_byte)
     {
@@ -239,3 +209,15 @@ bool _stringQueue_popMiddle(string_queue_t* queue, uint8_t index, uint8_t max_le
 
     return found_last_byte;
 }
+
+#ifdef UTILS_QUEUE_STATS
+void stringQueue_getStats(string_queue_t* queue, queue_stats_t* stats_out)
+{
+    circularBuffer_getStats(&queue->buffer, stats_out);
+}
+
+void stringQueue_resetStats(string_queue_t* queue)
+{
+    circularBuffer_resetStats(&queue->buffer);
+}
+#endif
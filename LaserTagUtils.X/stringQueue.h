@@ -41,6 +41,12 @@ uint8_t stringQueue_size(string_queue_t* queue);
 // The difference between capacity and size
 uint8_t stringQueue_freeCapacity(string_queue_t* queue);
 
+#ifdef UTILS_QUEUE_STATS
+// See circularBuffer_getStats
+void stringQueue_getStats(string_queue_t* queue, queue_stats_t* stats_out);
+void stringQueue_resetStats(string_queue_t* queue);
+#endif
+
 // Returns true if the queue contains at least one full string. Returns false if the queue is empty or only contains a
 // partial string
 bool stringQueue_hasFullString(string_queue_t* queue);
@@ -0,0 +1,184 @@
+#ifndef TYPEDQUEUE_H
+#define TYPEDQUEUE_H
+
+#include "queueStats.h"
+#include "spscQueue.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// TYPED_QUEUE_DEFINE stamps out a queue type whose elements are a given type, typically a small struct, along with
+// static inline functions to use it. Each push and pop moves a whole element with a single bounds check and a single
+// index update, so an element is never split, e.g. a gap width is never seen without its pulse width.
+//
+// The generated queue has the same single-producer, single-consumer guarantees as an SpscQueue: the producer is the
+// only writer of the back index, the consumer is the only writer of the front index, the indices and elements are
+// volatile, and an element is written or read before the index that publishes or releases it. As with an SpscQueue, the
+// length must be a power of two between 2 and 256 inclusive, and the queue can hold one fewer element than its length.
+//
+// Usage:
+//
+//     typedef struct
+//     {
+//         uint8_t gap;
+//         uint8_t pulse;
+//     } pulse_pair_t;
+//
+//     TYPED_QUEUE_DEFINE(pulse_pair_queue_t, pulsePairQueue, pulse_pair_t, 64)
+//
+//     static pulse_pair_queue_t g_queue;
+//     pulsePairQueue_initialize(&g_queue);
+//
+// This defines pulse_pair_queue_t and the functions pulsePairQueue_initialize, pulsePairQueue_push,
+// pulsePairQueue_pop, pulsePairQueue_size and pulsePairQueue_capacity, plus pulsePairQueue_getStats and
+// pulsePairQueue_resetStats if UTILS_QUEUE_STATS is defined. Push and pop take a pointer to an element.
+//
+// Large elements can be pushed and popped in place instead of copied. The producer calls pulsePairQueue_reserve, fills
+// in the returned slot and calls pulsePairQueue_commit, and the consumer calls pulsePairQueue_peek, reads the returned
+// element and calls pulsePairQueue_release. As with push and pop, the element is published or freed by a single write
+// of an index once it has been written or read.
+
+// Expands to its arguments if queue stats are enabled, and to nothing otherwise. See queueStats.h
+#ifdef UTILS_QUEUE_STATS
+#define _TYPED_QUEUE_STATS(...) __VA_ARGS__
+#else
+#define _TYPED_QUEUE_STATS(...)
+#endif
+
+#define TYPED_QUEUE_DEFINE(queue_t, prefix, element_t, length)                               \
+    typedef struct                                                                           \
+    {                                                                                        \
+        /* Index of the first element in the queue. Written only by the consumer */          \
+        volatile uint8_t front_index;                                                        \
+        /* Index one past the last element in the queue. Written only by the producer */     \
+        volatile uint8_t back_index;                                                         \
+        volatile element_t elements[SPSC_QUEUE_CHECKED_LENGTH(length)];                      \
+        _TYPED_QUEUE_STATS(queue_stats_t stats;)                                             \
+    } queue_t;                                                                               \
+                                                                                             \
+    static inline void prefix##_initialize(queue_t* queue)                                   \
+    {                                                                                        \
+        queue->front_index = 0;                                                              \
+        queue->back_index = 0;                                                               \
+        _TYPED_QUEUE_STATS(queueStats_reset(&queue->stats);)                                 \
+    }                                                                                        \
+                                                                                             \
+    /* Producer only. Returns false if the queue is full, true otherwise */                  \
+    static inline bool prefix##_push(queue_t* queue, element_t* element)                     \
+    {                                                                                        \
+        uint8_t front_index = queue->front_index;                                            \
+        uint8_t back_index = queue->back_index;                                              \
+        uint8_t next_back_index = (back_index + 1) & (uint8_t)((length)-1);                  \
+                                                                                             \
+        if (next_back_index == front_index)                                                  \
+        {                                                                                    \
+            _TYPED_QUEUE_STATS(queueStats_recordFailedPush(&queue->stats);)                  \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        queue->elements[back_index] = *element;                                              \
+        queue->back_index = next_back_index;                                                 \
+                                                                                             \
+        _TYPED_QUEUE_STATS(queueStats_recordPush(&queue->stats,                              \
+                                                 (uint8_t)(next_back_index - front_index)    \
+                                                     & (uint8_t)((length)-1),                \
+                                                 (uint8_t)((length)-1));)                    \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Consumer only. Returns false if the queue is empty, true otherwise */                 \
+    static inline bool prefix##_pop(queue_t* queue, element_t* element_out)                  \
+    {                                                                                        \
+        uint8_t front_index = queue->front_index;                                            \
+                                                                                             \
+        if (front_index == queue->back_index)                                                \
+        {                                                                                    \
+            _TYPED_QUEUE_STATS(queueStats_recordFailedPop(&queue->stats);)                   \
+            return false;                                                                    \
+        }                                                                                    \
+                                                                                             \
+        *element_out = queue->elements[front_index];                                         \
+        queue->front_index = (front_index + 1) & (uint8_t)((length)-1);                      \
+                                                                                             \
+        return true;                                                                         \
+    }                                                                                        \
+                                                                                             \
+    /* Producer only. Returns the slot that the next element is pushed into, so that it can  \
+       be written in place, or null if the queue is full. The element isn't in the queue     \
+       until prefix##_commit is called */                                                    \
+    static inline volatile element_t* prefix##_reserve(queue_t* queue)                       \
+    {                                                                                        \
+        uint8_t back_index = queue->back_index;                                              \
+                                                                                             \
+        if (((back_index + 1) & (uint8_t)((length)-1)) == queue->front_index)                \
+        {                                                                                    \
+            _TYPED_QUEUE_STATS(queueStats_recordFailedPush(&queue->stats);)                  \
+            return 0;                                                                        \
+        }                                                                                    \
+                                                                                             \
+        return &queue->elements[back_index];                                                 \
+    }                                                                                        \
+                                                                                             \
+    /* Producer only. Push the element written into the slot returned by prefix##_reserve */ \
+    static inline void prefix##_commit(queue_t* queue)                                       \
+    {                                                                                        \
+        _TYPED_QUEUE_STATS(uint8_t front_index = queue->front_index;)                        \
+        uint8_t next_back_index = (queue->back_index + 1) & (uint8_t)((length)-1);           \
+                                                                                             \
+        queue->back_index = next_back_index;                                                 \
+                                                                                             \
+        _TYPED_QUEUE_STATS(queueStats_recordPush(&queue->stats,                              \
+                                                 (uint8_t)(next_back_index - front_index)    \
+                                                     & (uint8_t)((length)-1),                \
+                                                 (uint8_t)((length)-1));)                    \
+    }                                                                                        \
+                                                                                             \
+    /* Consumer only. Returns the element at the front of the queue, so that it can be read  \
+       in place, or null if the queue is empty. The element stays in the queue until         \
+       prefix##_release is called */                                                         \
+    static inline volatile element_t* prefix##_peek(queue_t* queue)                          \
+    {                                                                                        \
+        uint8_t front_index = queue->front_index;                                            \
+                                                                                             \
+        if (front_index == queue->back_index)                                                \
+            return 0;                                                                        \
+                                                                                             \
+        return &queue->elements[front_index];                                                \
+    }                                                                                        \
+                                                                                             \
+    /* Consumer only. Pop the element returned by prefix##_peek */                           \
+    static inline void prefix##_release(queue_t* queue)                                      \
+    {                                                                                        \
+        queue->front_index = (queue->front_index + 1) & (uint8_t)((length)-1);               \
+    }                                                                                        \
+                                                                                             \
+    /* The number of elements in the queue. See spscQueue_size */                            \
+    static inline uint8_t prefix##_size(queue_t* queue)                                      \
+    {                                                                                        \
+        uint8_t front_index = queue->front_index;                                            \
+        uint8_t back_index = queue->back_index;                                              \
+                                                                                             \
+        return (uint8_t)(back_index - front_index) & (uint8_t)((length)-1);                  \
+    }                                                                                        \
+                                                                                             \
+    static inline uint8_t prefix##_capacity(queue_t* queue)                                  \
+    {                                                                                        \
+        (void)queue;                                                                         \
+        return (uint8_t)((length)-1);                                                        \
+    }                                                                                        \
+                                                                                             \
+    /* Copy out or clear the queue's stats. Only defined with UTILS_QUEUE_STATS. See         \
+       queueStats.h */                                                                       \
+    _TYPED_QUEUE_STATS(                                                                      \
+        static inline void prefix##_getStats(queue_t* queue, queue_stats_t* stats_out)       \
+        {                                                                                    \
+            *stats_out = queue->stats;                                                       \
+        }                                                                                    \
+                                                                                             \
+        static inline void prefix##_resetStats(queue_t* queue)                               \
+        {                                                                                    \
+            queueStats_reset(&queue->stats);                                                 \
+        })
+
+#endif /* TYPEDQUEUE_H */
@@ -0,0 +1,20 @@
+#ifndef UTILSINLINE_H
+#define UTILSINLINE_H
+
+// The hot utility functions, e.g. circularBuffer_get and bitArray_getBit, are defined in their headers, qualified with
+// UTILS_INLINE, inside a block that is normally only compiled by the module's own source file.
+//
+// By default UTILS_INLINE is empty, so each function is compiled once, in its module, and called like any other.
+//
+// Define UTILS_STATIC_INLINE for the whole project, e.g. in the compiler's preprocessor macros, to instead define these
+// functions static inline in every file that includes their headers. The compiler can then inline them into their
+// callers and fold constant arguments. On PIC16 this saves the call and return, and one of the 16 hardware stack
+// levels, per call, at the cost of program memory wherever they are inlined.
+
+#ifdef UTILS_STATIC_INLINE
+#define UTILS_INLINE static inline
+#else
+#define UTILS_INLINE
+#endif
+
+#endif /* UTILSINLINE_H */